@@ -1,9 +1,13 @@
 #include "args.h"
+#include "experiment_plan.h"
 #include "helpers.h"
 #include "logger.h"
 #include <sstream>
+#include <fstream>
 #include <getopt.h>
 #include <assert.h>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace DynoGraph;
 using std::string;
@@ -19,23 +23,75 @@ static const option long_options[] = {
     {"num-trials" , required_argument, 0, 0},
     {"num-alg-trials", required_argument, 0, 0},
     {"sources-path", required_argument, 0, 0},
+    {"batch-stats", no_argument, 0, 0},
+    {"undirected" , no_argument, 0, 0},
+    {"numa-nodes" , required_argument, 0, 0},
+    {"numa-mapping", required_argument, 0, 0},
+    {"aggregate-weight", required_argument, 0, 0},
+    {"aggregate-time", required_argument, 0, 0},
+    {"pipeline-threads", required_argument, 0, 0},
+    {"sort-once"  , no_argument, 0, 0},
+    {"track-sources", no_argument, 0, 0},
+    {"replay-rate", required_argument, 0, 0},
+    {"query-interval-ms", required_argument, 0, 0},
+    {"query-threads", required_argument, 0, 0},
+    {"thread-sweep", required_argument, 0, 0},
+    {"experiment-plan", required_argument, 0, 0},
+    {"interleave-engines", no_argument, 0, 0},
+    {"start-batch", required_argument, 0, 0},
+    {"snapshot-source-order", no_argument, 0, 0},
     {"help"       , no_argument, 0, 0},
     {NULL         , 0, 0, 0}
 };
 
 static const std::pair<string, string> option_descriptions[] = {
     {"num-epochs" , "Number of epochs (algorithm updates) in the benchmark"},
-    {"input-path" , "File path to the graph edge list to load (.graph.el or .graph.bin)"},
+    {"input-path" , "File path to the graph edge list to load (.graph.el or .graph.bin).\n"
+        "\t\tTo read binary edges as they arrive, use ne-nv-timeout_ms@source.stream,\n"
+        "\t\twhere source is - (stdin), a FIFO, or unix:<path> to listen on a socket"},
     {"batch-size" , "Number of edges in each batch of insertions"},
     {"alg-names"  , "Algorithms to run in each epoch"},
     {"sort-mode"  , "Controls batch pre-processing: \n"
         "\t\tunsorted (no preprocessing, default),\n"
-        "\t\tpresort (sort and deduplicate before insert), or\n "
+        "\t\tpresort (sort by degree and deduplicate before insert),\n"
+        "\t\tlocality (sort by source and destination and deduplicate before insert),\n"
+        "\t\thybrid (sort into degree buckets, then by source and destination, and deduplicate before insert), or\n"
         "\t\tsnapshot (clear out graph and reconstruct for each batch)"},
     {"window-size", "Percentage of the graph to hold in memory (computed using timestamps) "},
     {"num-trials" , "Number of times to repeat the benchmark"},
     {"num-alg-trials" , "Number of times to repeat algorithms in each epoch"},
     {"sources-path" , "File path to the list of source vertices to use for graph algorithms"},
+    {"batch-stats", "Record statistics about each batch (distinct vertices and edges, degree skew, etc.) before inserting it"},
+    {"undirected" , "Treat the input as an undirected graph. Each batch is symmetrized to hold both directions of every edge"},
+    {"numa-nodes" , "Split each batch into one partition per NUMA node, by the owner of each edge's source vertex (default 1)"},
+    {"numa-mapping", "How vertices are assigned to NUMA nodes: \n"
+        "\t\tblock (each node owns a contiguous range of vertex ID's, default), or\n"
+        "\t\tcyclic (vertex ID's are assigned to nodes round-robin)"},
+    {"aggregate-weight", "How to combine the weights of duplicate edges in a batch: \n"
+        "\t\tsum (default), max, or count (number of duplicates).\n"
+        "\t\tAlso combines duplicates in unsorted mode"},
+    {"aggregate-time", "Which timestamp to keep when combining duplicate edges in a batch: \n"
+        "\t\tlast (default), or first.\n"
+        "\t\tAlso combines duplicates in unsorted mode"},
+    {"pipeline-threads", "Prepare the next batch on this many threads while the current batch is inserted (default 0, disabled)"},
+    {"sort-once"  , "Sort the whole dataset in parallel before the first trial, so each batch is ready to insert.\n"
+        "\t\tKeeps a preprocessed copy of every batch in memory. Not available in snapshot mode"},
+    {"track-sources", "Keep track of out-degrees as batches come and go, instead of sorting every vertex in the graph to pick sources"},
+    {"replay-rate", "Release each batch when its last edge would arrive, replaying this many timestamp units per second.\n"
+        "\t\tBatches that come due while the graph is busy are inserted together. (default 0, run flat out)"},
+    {"query-interval-ms", "Run the algs on a separate thread every N milliseconds, while batches are inserted continuously.\n"
+        "\t\tOnly for graphs that support concurrent reads. (default 0, disabled)"},
+    {"query-threads", "Number of threads to run the algs on with --query-interval-ms (default 1)"},
+    {"thread-sweep", "Comma-separated list of thread counts (e.g. 1,2,4,8). Runs all the trials at each thread count,\n"
+        "\t\tthen reports the speedup and parallel efficiency of each region relative to the first count"},
+    {"experiment-plan", "JSON file with a list of configurations to run in sequence, loading the input only once.\n"
+        "\t\tEach configuration is an object of options that override the command line,\n"
+        "\t\te.g. [{\"batch-size\": 1000, \"alg-names\": [\"bfs\"]}, {\"window-size\": 0.5, \"sort-once\": true}]"},
+    {"interleave-engines", "When comparing engines, alternate between them every trial, so drift over the run affects each one equally"},
+    {"start-batch", "Bulk load every batch before this one, recompute the algs from scratch, then continue inserting one batch\n"
+        "\t\tat a time from here. Epochs that fall before this batch are skipped. (default 0)"},
+    {"snapshot-source-order", "In snapshot mode, leave each snapshot sorted by source and destination instead of by out degree.\n"
+        "\t\tSkips the degree sort, for engines that don't benefit from it"},
     {"help"       , "Print help"},
 };
 
@@ -63,7 +119,27 @@ Args::parse(int argc, char *argv[])
     args.num_trials = 1;
     args.num_alg_trials = 1;
     args.sources_path = "";
+    args.batch_stats = false;
+    args.undirected = false;
+    args.numa_nodes = 1;
+    args.numa_mapping = Args::NUMA_MAPPING::BLOCK;
+    args.aggregation = {EdgeAggregation::WEIGHT::SUM, EdgeAggregation::TIME::LAST};
+    args.aggregate = false;
+    args.pipeline_threads = 0;
+    args.sort_once = false;
+    args.track_sources = false;
+    args.replay_rate = 0;
+    args.query_interval_ms = 0;
+    args.query_threads = 1;
+    args.thread_sweep.clear();
+    args.experiment_plan = "";
+    args.interleave_engines = false;
+    args.start_batch = 0;
+    args.snapshot_source_order = false;
 
+    // Start over from the first argument, since the experiment plan parses arguments more than once
+    // Zero also tells GNU getopt to reset its internal state, not just the index
+    optind = 0;
     int option_index;
     while (1)
     {
@@ -97,8 +173,10 @@ Args::parse(int argc, char *argv[])
             if      (sort_mode_str == "unsorted") { args.sort_mode = Args::SORT_MODE::UNSORTED; }
             else if (sort_mode_str == "presort")  { args.sort_mode = Args::SORT_MODE::PRESORT;  }
             else if (sort_mode_str == "snapshot") { args.sort_mode = Args::SORT_MODE::SNAPSHOT; }
+            else if (sort_mode_str == "locality") { args.sort_mode = Args::SORT_MODE::LOCALITY; }
+            else if (sort_mode_str == "hybrid")   { args.sort_mode = Args::SORT_MODE::HYBRID;   }
             else {
-                logger << "sort-mode must be one of ['unsorted', 'presort', 'snapshot']\n";
+                logger << "sort-mode must be one of ['unsorted', 'presort', 'snapshot', 'locality', 'hybrid']\n";
                 die();
             }
 
@@ -114,6 +192,81 @@ Args::parse(int argc, char *argv[])
         } else if (option_name == "sources-path") {
             args.sources_path = optarg;
 
+        } else if (option_name == "batch-stats") {
+            args.batch_stats = true;
+
+        } else if (option_name == "undirected") {
+            args.undirected = true;
+
+        } else if (option_name == "numa-nodes") {
+            args.numa_nodes = static_cast<int64_t>(std::stoll(optarg));
+
+        } else if (option_name == "numa-mapping") {
+            std::string numa_mapping_str = optarg;
+            if      (numa_mapping_str == "block")  { args.numa_mapping = Args::NUMA_MAPPING::BLOCK;  }
+            else if (numa_mapping_str == "cyclic") { args.numa_mapping = Args::NUMA_MAPPING::CYCLIC; }
+            else {
+                logger << "numa-mapping must be one of ['block', 'cyclic']\n";
+                die();
+            }
+
+        } else if (option_name == "aggregate-weight") {
+            std::string weight_str = optarg;
+            if      (weight_str == "sum")   { args.aggregation.weight = EdgeAggregation::WEIGHT::SUM;   }
+            else if (weight_str == "max")   { args.aggregation.weight = EdgeAggregation::WEIGHT::MAX;   }
+            else if (weight_str == "count") { args.aggregation.weight = EdgeAggregation::WEIGHT::COUNT; }
+            else {
+                logger << "aggregate-weight must be one of ['sum', 'max', 'count']\n";
+                die();
+            }
+            args.aggregate = true;
+
+        } else if (option_name == "aggregate-time") {
+            std::string time_str = optarg;
+            if      (time_str == "last")  { args.aggregation.time = EdgeAggregation::TIME::LAST;  }
+            else if (time_str == "first") { args.aggregation.time = EdgeAggregation::TIME::FIRST; }
+            else {
+                logger << "aggregate-time must be one of ['last', 'first']\n";
+                die();
+            }
+            args.aggregate = true;
+
+        } else if (option_name == "pipeline-threads") {
+            args.pipeline_threads = static_cast<int64_t>(std::stoll(optarg));
+
+        } else if (option_name == "sort-once") {
+            args.sort_once = true;
+
+        } else if (option_name == "track-sources") {
+            args.track_sources = true;
+
+        } else if (option_name == "replay-rate") {
+            args.replay_rate = std::stod(optarg);
+
+        } else if (option_name == "query-interval-ms") {
+            args.query_interval_ms = static_cast<int64_t>(std::stoll(optarg));
+
+        } else if (option_name == "query-threads") {
+            args.query_threads = static_cast<int64_t>(std::stoll(optarg));
+
+        } else if (option_name == "thread-sweep") {
+            args.thread_sweep.clear();
+            for (std::string count : split(optarg, ',')) {
+                args.thread_sweep.push_back(static_cast<int64_t>(std::stoll(count)));
+            }
+
+        } else if (option_name == "experiment-plan") {
+            args.experiment_plan = optarg;
+
+        } else if (option_name == "interleave-engines") {
+            args.interleave_engines = true;
+
+        } else if (option_name == "start-batch") {
+            args.start_batch = static_cast<int64_t>(std::stoll(optarg));
+
+        } else if (option_name == "snapshot-source-order") {
+            args.snapshot_source_order = true;
+
         } else if (option_name == "help") {
             print_help(argv[0]);
             die();
@@ -130,6 +283,93 @@ Args::parse(int argc, char *argv[])
     return args;
 }
 
+// Removes the arguments that getopt reads as the flag --name, including abbreviations of it
+static void
+remove_flag(std::vector<string> &options, const string &name)
+{
+    std::vector<char*> argv;
+    for (string &o : options) { argv.push_back(&o[0]); }
+    argv.push_back(nullptr);
+    // getopt reorders the pointers, so matches are found by address rather than by position
+    std::vector<char*> matches;
+    optind = 0;
+    int option_index;
+    int c;
+    while ((c = getopt_long(static_cast<int>(options.size()), argv.data(), "", long_options, &option_index)) != -1) {
+        if (c != '?' && name == long_options[option_index].name) { matches.push_back(argv[optind - 1]); }
+    }
+    std::vector<string> kept;
+    for (string &o : options) {
+        if (std::find(matches.begin(), matches.end(), &o[0]) == matches.end()) { kept.push_back(o); }
+    }
+    options.swap(kept);
+}
+
+std::vector<Args>
+Args::parse_plan(int argc, char *argv[])
+{
+    Logger &logger = Logger::get_instance();
+    Args base = parse(argc, argv);
+
+    std::vector<std::vector<PlanOption>> plan;
+    try {
+        plan = read_experiment_plan(base.experiment_plan);
+    } catch (const std::runtime_error &e) {
+        logger << e.what() << "\n";
+        die();
+    }
+
+    std::vector<Args> configs;
+    for (const std::vector<PlanOption> &entry : plan)
+    {
+        // Append the options from the plan to the command line, so they take precedence
+        std::vector<string> options(argv, argv + argc);
+        for (const PlanOption &plan_option : entry)
+        {
+            const string &name = plan_option.first;
+            const std::vector<string> &values = plan_option.second;
+            const option *opt = long_options;
+            while (opt->name && name != opt->name) { ++opt; }
+            if (!opt->name || name == "help") {
+                logger << "Invalid experiment plan: unknown option " << name << "\n";
+                die();
+            }
+            // Every configuration must be able to reuse the same loaded dataset
+            if (name == "input-path" || name == "undirected" || name == "experiment-plan") {
+                logger << "Invalid experiment plan: --" << name << " cannot change between configurations\n";
+                die();
+            }
+            if (opt->has_arg == no_argument) {
+                // Flags are turned on by adding them, and off by taking them out of the command line
+                if (values.size() != 1 || (values[0] != "true" && values[0] != "false")) {
+                    logger << "Invalid experiment plan: --" << name << " must be true or false\n";
+                    die();
+                }
+                if (values[0] == "true") {
+                    options.push_back("--" + name);
+                } else {
+                    remove_flag(options, name);
+                }
+            } else {
+                // Lists are joined the same way they are written on the command line
+                char delim = name == "alg-names" ? ' ' : ',';
+                string list;
+                for (const string &value : values) {
+                    if (!list.empty()) { list += delim; }
+                    list += value;
+                }
+                options.push_back("--" + name);
+                options.push_back(list);
+            }
+        }
+        std::vector<char*> config_argv;
+        for (string &o : options) { config_argv.push_back(&o[0]); }
+        config_argv.push_back(nullptr);
+        configs.push_back(parse(static_cast<int>(options.size()), config_argv.data()));
+    }
+    return configs;
+}
+
 string
 Args::validate() const
 {
@@ -152,6 +392,59 @@ Args::validate() const
     if (num_alg_trials < 1) {
         oss << "\t--num-alg-trials must be positive\n";
     }
+    if (numa_nodes < 1) {
+        oss << "\t--numa-nodes must be positive\n";
+    }
+    if (pipeline_threads < 0) {
+        oss << "\t--pipeline-threads cannot be negative\n";
+    }
+    if (sort_once && sort_mode == SORT_MODE::SNAPSHOT) {
+        oss << "\t--sort-once does not apply to snapshot mode\n";
+    }
+    if (replay_rate < 0) {
+        oss << "\t--replay-rate cannot be negative\n";
+    }
+    if (replay_rate > 0 && pipeline_threads > 0) {
+        oss << "\t--replay-rate cannot be combined with --pipeline-threads\n";
+    }
+    if (query_interval_ms < 0) {
+        oss << "\t--query-interval-ms cannot be negative\n";
+    }
+    if (query_interval_ms > 0) {
+        if (query_threads < 1) {
+            oss << "\t--query-threads must be positive\n";
+        }
+        if (sort_mode == SORT_MODE::SNAPSHOT) {
+            oss << "\t--query-interval-ms does not apply to snapshot mode\n";
+        }
+        if (pipeline_threads > 0 || replay_rate > 0) {
+            oss << "\t--query-interval-ms cannot be combined with --pipeline-threads or --replay-rate\n";
+        }
+        // The concurrent driver neither describes batches nor tracks degrees
+        if (batch_stats || track_sources) {
+            oss << "\t--query-interval-ms cannot be combined with --batch-stats or --track-sources\n";
+        }
+    }
+    if (start_batch < 0) {
+        oss << "\t--start-batch cannot be negative\n";
+    }
+    if (start_batch > 0) {
+        if (sort_mode == SORT_MODE::SNAPSHOT) {
+            oss << "\t--start-batch does not apply to snapshot mode\n";
+        }
+        if (query_interval_ms > 0) {
+            oss << "\t--start-batch cannot be combined with --query-interval-ms\n";
+        }
+    }
+    if (snapshot_source_order && sort_mode != SORT_MODE::SNAPSHOT) {
+        oss << "\t--snapshot-source-order only applies to snapshot mode\n";
+    }
+    for (int64_t num_threads : thread_sweep) {
+        if (num_threads < 1) {
+            oss << "\t--thread-sweep thread counts must be positive\n";
+            break;
+        }
+    }
 
     return oss.str();
 }
@@ -163,6 +456,42 @@ DynoGraph::operator <<(std::ostream& os, Args::SORT_MODE sort_mode)
         case Args::SORT_MODE::UNSORTED: os << "unsorted"; break;
         case Args::SORT_MODE::PRESORT: os << "presort"; break;
         case Args::SORT_MODE::SNAPSHOT: os << "snapshot"; break;
+        case Args::SORT_MODE::LOCALITY: os << "locality"; break;
+        case Args::SORT_MODE::HYBRID: os << "hybrid"; break;
+        default: os << "UNINITIALIZED"; break;
+    }
+    return os;
+}
+
+std::ostream&
+DynoGraph::operator <<(std::ostream& os, Args::NUMA_MAPPING numa_mapping)
+{
+    switch (numa_mapping) {
+        case Args::NUMA_MAPPING::BLOCK: os << "block"; break;
+        case Args::NUMA_MAPPING::CYCLIC: os << "cyclic"; break;
+        default: os << "UNINITIALIZED"; break;
+    }
+    return os;
+}
+
+std::ostream&
+DynoGraph::operator <<(std::ostream& os, EdgeAggregation::WEIGHT weight)
+{
+    switch (weight) {
+        case EdgeAggregation::WEIGHT::SUM: os << "sum"; break;
+        case EdgeAggregation::WEIGHT::MAX: os << "max"; break;
+        case EdgeAggregation::WEIGHT::COUNT: os << "count"; break;
+        default: os << "UNINITIALIZED"; break;
+    }
+    return os;
+}
+
+std::ostream&
+DynoGraph::operator <<(std::ostream& os, EdgeAggregation::TIME time)
+{
+    switch (time) {
+        case EdgeAggregation::TIME::LAST: os << "last"; break;
+        case EdgeAggregation::TIME::FIRST: os << "first"; break;
         default: os << "UNINITIALIZED"; break;
     }
     return os;
@@ -179,8 +508,32 @@ DynoGraph::operator <<(std::ostream& os, const Args& args)
         << "\"num_trials\":"  << args.num_trials << ","
         << "\"num_alg_trials\":"  << args.num_alg_trials << ","
         << "\"sources_path\":" << args.sources_path << ","
+        << "\"batch_stats\":" << (args.batch_stats ? "true" : "false") << ","
+        << "\"undirected\":" << (args.undirected ? "true" : "false") << ","
+        << "\"numa_nodes\":" << args.numa_nodes << ","
+        << "\"numa_mapping\":\"" << args.numa_mapping << "\","
+        << "\"aggregate_weight\":\"" << args.aggregation.weight << "\","
+        << "\"aggregate_time\":\"" << args.aggregation.time << "\","
+        << "\"aggregate\":" << (args.aggregate ? "true" : "false") << ","
+        << "\"pipeline_threads\":" << args.pipeline_threads << ","
+        << "\"sort_once\":" << (args.sort_once ? "true" : "false") << ","
+        << "\"track_sources\":" << (args.track_sources ? "true" : "false") << ","
+        << "\"replay_rate\":" << args.replay_rate << ","
+        << "\"query_interval_ms\":" << args.query_interval_ms << ","
+        << "\"query_threads\":" << args.query_threads << ","
         << "\"sort_mode\":\""   << args.sort_mode << "\",";
 
+    os << "\"experiment_plan\":\"" << args.experiment_plan << "\",";
+    os << "\"interleave_engines\":" << (args.interleave_engines ? "true" : "false") << ",";
+    os << "\"start_batch\":" << args.start_batch << ",";
+    os << "\"snapshot_source_order\":" << (args.snapshot_source_order ? "true" : "false") << ",";
+    os << "\"thread_sweep\":[";
+    for (size_t i = 0; i < args.thread_sweep.size(); ++i) {
+        if (i != 0) { os << ","; }
+        os << args.thread_sweep[i];
+    }
+    os << "],";
+
     os << "\"alg_names\":[";
     for (size_t i = 0; i < args.alg_names.size(); ++i) {
         if (i != 0) { os << ","; }
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include "edge.h"
 
 namespace DynoGraph {
 
@@ -24,7 +25,11 @@ struct Args
         // Sort and deduplicate each batch before returning it
         PRESORT,
         // Each batch is a cumulative snapshot of all edges in previous batches
-        SNAPSHOT
+        SNAPSHOT,
+        // Sort each batch by source and destination, and deduplicate
+        LOCALITY,
+        // Sort each batch into buckets by out degree, then by source and destination within each bucket
+        HYBRID
     } sort_mode;
     // Percentage of the graph to hold in memory
     double window_size;
@@ -34,15 +39,61 @@ struct Args
     int64_t num_alg_trials;
     // File path to the list of source vertices to use for graph algorithms
     std::string sources_path;
+    // Record summary statistics for each batch before inserting it
+    bool batch_stats;
+    // Treat the input as an undirected graph, so each batch holds both directions of every edge
+    bool undirected;
+    // Number of NUMA nodes to partition each batch across
+    int64_t numa_nodes;
+    // How vertices are assigned to NUMA nodes
+    enum class NUMA_MAPPING {
+        // Each node owns a contiguous block of vertex ID's
+        BLOCK,
+        // Vertex ID's are dealt out to nodes round-robin
+        CYCLIC
+    } numa_mapping;
+    // How duplicate edges in a batch are combined during preprocessing
+    EdgeAggregation aggregation;
+    // Combine duplicate edges in unsorted mode too, without sorting the batch
+    bool aggregate;
+    // Threads for preparing the next batch while the current one is inserted (0 disables pipelining)
+    int64_t pipeline_threads;
+    // Preprocess every batch once before the first trial, rather than before each insertion
+    bool sort_once;
+    // Pick source vertices from a degree tracker that follows the window, rather than asking the graph
+    bool track_sources;
+    // Release batches in real time according to their timestamps, replaying this many timestamp units per second
+    // (0 runs flat out)
+    double replay_rate;
+    // Run the algs on a separate thread every this many milliseconds while batches are inserted (0 disables)
+    int64_t query_interval_ms;
+    // Number of threads for running the algs alongside the insertions
+    int64_t query_threads;
+    // Rerun every trial at each of these OpenMP thread counts, and compare the region times between them
+    std::vector<int64_t> thread_sweep;
+    // JSON file listing configurations to run one after another over the same input
+    std::string experiment_plan;
+    // When comparing several engines, run one trial of each engine in turn rather than all trials of one at a time
+    bool interleave_engines;
+    // Build the graph from every batch before this one with the bulk constructor, then insert the rest one at a time
+    int64_t start_batch;
+    // In snapshot mode, hand out snapshots sorted by source and destination, skipping the sort by out degree
+    bool snapshot_source_order;
 
     Args() = default;
     std::string validate() const;
 
     static Args parse(int argc, char **argv);
+    // Returns one Args for each configuration in the experiment plan
+    // Each configuration starts from the command line arguments, then applies the options in its plan entry
+    static std::vector<Args> parse_plan(int argc, char **argv);
     static void print_help(std::string argv0);
 };
 
 std::ostream& operator <<(std::ostream& os, Args::SORT_MODE sort_mode);
+std::ostream& operator <<(std::ostream& os, Args::NUMA_MAPPING numa_mapping);
+std::ostream& operator <<(std::ostream& os, EdgeAggregation::WEIGHT weight);
+std::ostream& operator <<(std::ostream& os, EdgeAggregation::TIME time);
 std::ostream& operator <<(std::ostream& os, const Args& args);
 
 } // end namespace DynoGraph
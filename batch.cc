@@ -1,32 +1,253 @@
 #include "batch.h"
+#include "edge_kernels.h"
+#include "helpers.h"
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 using namespace DynoGraph;
 
+namespace {
+
+// Edge annotated with the out-degree of each endpoint, used as a sort key
+struct DegreeKeyedEdge
+{
+    int64_t src_degree;
+    int64_t dst_degree;
+    Edge edge;
+};
+
+// Edge annotated with the degree bucket of its source vertex, used as a sort key
+struct BucketKeyedEdge
+{
+    int64_t bucket;
+    Edge edge;
+};
+
+// Returns the offset of the first edge in each run of edges with the same source vertex,
+// followed by the total number of edges. Edges must already be grouped by source vertex.
+pvector<int64_t>
+find_source_offsets(const Edge* edges, int64_t num_edges)
+{
+    auto is_run_start = [edges](int64_t i) {
+        return i == 0 || edges[i].src != edges[i-1].src;
+    };
+
+    // Count the number of runs that start in each chunk
+    int64_t num_chunks = get_num_chunks();
+    pvector<int64_t> chunk_offsets(num_chunks + 1);
+    chunk_offsets[0] = 0;
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t count = 0;
+        for (int64_t i = num_edges * c / num_chunks; i < num_edges * (c+1) / num_chunks; ++i) {
+            if (is_run_start(i)) { ++count; }
+        }
+        chunk_offsets[c+1] = count;
+    }
+    // Prefix sum gives the position of each chunk's runs in the output
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        chunk_offsets[c+1] += chunk_offsets[c];
+    }
+
+    // Write out the start of each run, plus a sentinel at the end
+    pvector<int64_t> offsets(chunk_offsets[num_chunks] + 1);
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t pos = chunk_offsets[c];
+        for (int64_t i = num_edges * c / num_chunks; i < num_edges * (c+1) / num_chunks; ++i) {
+            if (is_run_start(i)) { offsets[pos++] = i; }
+        }
+    }
+    offsets[offsets.size() - 1] = num_edges;
+    return offsets;
+}
+
+// After each chunk has packed its results at its beginning, slide them down to close the gaps
+// This has to go in order, since a chunk can land on top of the previous chunk's original position
+// Returns the new end of the edge list
+Edge*
+close_chunk_gaps(Edge* edges, const pvector<int64_t>& chunk_begin, const pvector<int64_t>& chunk_size)
+{
+    int64_t num_chunks = static_cast<int64_t>(chunk_size.size());
+    int64_t num_packed = chunk_size[0];
+    for (int64_t c = 1; c < num_chunks; ++c) {
+        if (num_packed != chunk_begin[c]) {
+            std::memmove(edges + num_packed, edges + chunk_begin[c], chunk_size[c] * sizeof(Edge));
+        }
+        num_packed += chunk_size[c];
+    }
+    return edges + num_packed;
+}
+
+// Returns the weight of an edge when it is the first of a set of duplicates
+int64_t
+initial_weight(const Edge& e, const EdgeAggregation& aggregation)
+{
+    return aggregation.weight == EdgeAggregation::WEIGHT::COUNT ? 1 : e.weight;
+}
+
+// Folds a duplicate edge into the combined edge, according to the aggregation policy
+void
+aggregate_edge(Edge& combined, const Edge& e, const EdgeAggregation& aggregation)
+{
+    switch (aggregation.weight) {
+        case EdgeAggregation::WEIGHT::SUM: combined.weight += e.weight; break;
+        case EdgeAggregation::WEIGHT::MAX: combined.weight = std::max(combined.weight, e.weight); break;
+        case EdgeAggregation::WEIGHT::COUNT: combined.weight += 1; break;
+    }
+    switch (aggregation.time) {
+        case EdgeAggregation::TIME::LAST: combined.timestamp = std::max(combined.timestamp, e.timestamp); break;
+        case EdgeAggregation::TIME::FIRST: combined.timestamp = std::min(combined.timestamp, e.timestamp); break;
+    }
+}
+
+void
+atomic_max(int64_t* p, int64_t value)
+{
+    int64_t current = __atomic_load_n(p, __ATOMIC_RELAXED);
+    while (value > current && !__atomic_compare_exchange_n(p, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+void
+atomic_min(int64_t* p, int64_t value)
+{
+    int64_t current = __atomic_load_n(p, __ATOMIC_RELAXED);
+    while (value < current && !__atomic_compare_exchange_n(p, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+}
+
+// Hash of the src and dst of an edge
+uint64_t
+hash_edge(const Edge& e)
+{
+    uint64_t h = static_cast<uint64_t>(e.src) * 0x9E3779B97F4A7C15ULL
+               ^ static_cast<uint64_t>(e.dst) * 0xC2B2AE3D27D4EB4FULL;
+    return h ^ (h >> 31);
+}
+
+// Combines each run of edges with the same src and dst into a single edge, in place
+// By default, weights are summed and the most recent timestamp is kept, which matches what
+// happens when the duplicates are inserted into the graph one at a time.
+// Combined edges with a timestamp older than threshold are dropped.
+// Edges must already be sorted by src and dst. Returns the new end of the edge list.
+Edge*
+combine_duplicate_edges(Edge* edges, int64_t num_edges, int64_t threshold, const EdgeAggregation& aggregation)
+{
+    auto same_edge = [](const Edge& a, const Edge& b) {
+        return a.src == b.src && a.dst == b.dst;
+    };
+
+    // Split the list into chunks, moving each boundary forward so no run is split between two chunks
+    int64_t num_chunks = get_num_chunks();
+    pvector<int64_t> chunk_begin(num_chunks + 1);
+    for (int64_t c = 0; c <= num_chunks; ++c) {
+        int64_t pos = std::max(num_edges * c / num_chunks, c > 0 ? chunk_begin[c-1] : 0);
+        while (pos > 0 && pos < num_edges && same_edge(edges[pos], edges[pos-1])) { ++pos; }
+        chunk_begin[c] = pos;
+    }
+
+    // Reduce each run within its chunk, packing the results at the start of the chunk
+    pvector<int64_t> chunk_size(num_chunks);
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t out = chunk_begin[c];
+        for (int64_t i = chunk_begin[c]; i < chunk_begin[c+1];) {
+            Edge combined = edges[i];
+            combined.weight = initial_weight(combined, aggregation);
+            for (++i; i < chunk_begin[c+1] && same_edge(edges[i], combined); ++i) {
+                aggregate_edge(combined, edges[i], aggregation);
+            }
+            if (combined.timestamp >= threshold) { edges[out++] = combined; }
+        }
+        chunk_size[c] = out - chunk_begin[c];
+    }
+    return close_chunk_gaps(edges, chunk_begin, chunk_size);
+}
+
+// Writes the reverse of each edge to out, skipping self loops. Returns the end of the output.
+Edge*
+reverse_edges(const Edge* edges, int64_t num_edges, Edge* out)
+{
+    // Count the edges each chunk will write
+    int64_t num_chunks = get_num_chunks();
+    pvector<int64_t> chunk_offsets(num_chunks + 1);
+    chunk_offsets[0] = 0;
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t count = 0;
+        for (int64_t i = num_edges * c / num_chunks; i < num_edges * (c+1) / num_chunks; ++i) {
+            if (edges[i].src != edges[i].dst) { ++count; }
+        }
+        chunk_offsets[c+1] = count;
+    }
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        chunk_offsets[c+1] += chunk_offsets[c];
+    }
+
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        Edge* pos = out + chunk_offsets[c];
+        for (int64_t i = num_edges * c / num_chunks; i < num_edges * (c+1) / num_chunks; ++i) {
+            const Edge& e = edges[i];
+            if (e.src != e.dst) { *pos++ = {e.dst, e.src, e.weight, e.timestamp}; }
+        }
+    }
+    return out + chunk_offsets[num_chunks];
+}
+
+} // end anonymous namespace
+
 int64_t
 Batch::num_vertices_affected() const
 {
-    // Get a list of just the vertex ID's in this batch
+    if (size() == 0) { return 0; }
+    int64_t max_id = max_vertex_id();
+    int64_t num_words = max_id / 64 + 1;
+
+    // When the vertex ID space is small compared to the batch, mark each vertex in a bitmap
+    if (num_words <= static_cast<int64_t>(size() * 2)) {
+        pvector<uint64_t> bitmap(num_words, 0);
+        #pragma omp parallel for
+        for (size_t i = 0; i < size(); ++i) {
+            for (int64_t v : {begin_iter[i].src, begin_iter[i].dst}) {
+                uint64_t bit = 1ULL << (v % 64);
+                #pragma omp atomic
+                bitmap[v / 64] |= bit;
+            }
+        }
+        int64_t count = 0;
+        #pragma omp parallel for reduction(+:count)
+        for (int64_t w = 0; w < num_words; ++w) {
+            count += __builtin_popcountll(bitmap[w]);
+        }
+        return count;
+    }
+
+    // Otherwise the bitmap would be mostly empty, so sort a list of the vertex ID's instead
     pvector<int64_t> vertices(size() * 2);
     std::transform(begin_iter, end_iter, vertices.begin(),
         [](const Edge& e){ return e.src; });
     std::transform(begin_iter, end_iter, vertices.begin() + size(),
         [](const Edge& e){ return e.dst; });
-
-    // Deduplicate
-    pvector<int64_t> unique_vertices(vertices.size());
     std::sort(vertices.begin(), vertices.end());
-    auto end = std::unique_copy(vertices.begin(), vertices.end(), unique_vertices.begin());
-    return static_cast<int64_t>(end - unique_vertices.begin());
+
+    // Count the first occurrence of each vertex ID
+    int64_t count = 1;
+    #pragma omp parallel for reduction(+:count)
+    for (size_t i = 1; i < vertices.size(); ++i) {
+        if (vertices[i] != vertices[i-1]) { ++count; }
+    }
+    return count;
 }
 
 int64_t
 Batch::max_vertex_id() const {
-    auto max_edge = std::max_element(begin_iter, end_iter,
-        [](const Edge& a, const Edge& b) {
-            return std::max(a.src, a.dst) < std::max(b.src, b.dst);
-        }
-    );
-    return std::max(max_edge->src, max_edge->dst);
+    EdgeBounds bounds = find_edge_bounds(begin_iter, size());
+    return std::max(bounds.max.src, bounds.max.dst);
 }
 
 void
@@ -39,68 +260,302 @@ Batch::filter(int64_t threshold)
 }
 
 void
-Batch::dedup_and_sort_by_out_degree()
+Batch::dedup(const EdgeAggregation& aggregation)
 {
     // Sort to prepare for deduplication
-    auto by_src_dest_time = [](const Edge& a, const Edge& b) {
-        // Order by src ascending, then dest ascending, then timestamp descending
-        // This way the edge with the most recent timestamp will be picked when deduplicating
-        return (a.src != b.src) ? a.src < b.src
-             : (a.dst != b.dst) ? a.dst < b.dst
-             :  a.timestamp > b.timestamp;
+    std::sort(begin_iter, end_iter, by_src_dst);
+
+    // Deduplicate the edge list in place
+    end_iter = combine_duplicate_edges(begin_iter, size(), std::numeric_limits<int64_t>::min(), aggregation);
+}
+
+void
+Batch::combine_sorted_duplicates(int64_t threshold, const EdgeAggregation& aggregation)
+{
+    end_iter = combine_duplicate_edges(begin_iter, size(), threshold, aggregation);
+}
+
+void
+Batch::aggregate_duplicates(const EdgeAggregation& aggregation)
+{
+    int64_t n = size();
+    if (n == 0) { return; }
+
+    // Open addressing table with at least twice as many slots as edges
+    // Each slot holds the index of the first edge to claim it, which identifies the src and dst
+    int64_t num_slots = 1;
+    while (num_slots < 2 * n) { num_slots *= 2; }
+    pvector<int64_t> table(num_slots, -1);
+    // Aggregated weight, timestamp and index of first occurrence for each slot, starting from the identity
+    pvector<int64_t> slot_weight(num_slots, aggregation.weight == EdgeAggregation::WEIGHT::MAX
+        ? std::numeric_limits<int64_t>::min() : 0);
+    pvector<int64_t> slot_time(num_slots, aggregation.time == EdgeAggregation::TIME::LAST
+        ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max());
+    pvector<int64_t> slot_first(num_slots, std::numeric_limits<int64_t>::max());
+    pvector<int64_t> edge_slot(n);
+
+    // Find the slot for each edge, and fold the edge into it
+    #pragma omp parallel for
+    for (int64_t i = 0; i < n; ++i) {
+        const Edge& e = begin_iter[i];
+        int64_t s = static_cast<int64_t>(hash_edge(e) & (num_slots - 1));
+        while (true) {
+            int64_t owner = __atomic_load_n(&table[s], __ATOMIC_ACQUIRE);
+            // On failure, owner is updated to the edge that claimed the slot first
+            if (owner == -1 && __atomic_compare_exchange_n(&table[s], &owner, i, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            if (begin_iter[owner].src == e.src && begin_iter[owner].dst == e.dst) { break; }
+            s = (s + 1) & (num_slots - 1);
+        }
+        edge_slot[i] = s;
+        switch (aggregation.weight) {
+            case EdgeAggregation::WEIGHT::SUM: __atomic_fetch_add(&slot_weight[s], e.weight, __ATOMIC_RELAXED); break;
+            case EdgeAggregation::WEIGHT::MAX: atomic_max(&slot_weight[s], e.weight); break;
+            case EdgeAggregation::WEIGHT::COUNT: __atomic_fetch_add(&slot_weight[s], 1, __ATOMIC_RELAXED); break;
+        }
+        switch (aggregation.time) {
+            case EdgeAggregation::TIME::LAST: atomic_max(&slot_time[s], e.timestamp); break;
+            case EdgeAggregation::TIME::FIRST: atomic_min(&slot_time[s], e.timestamp); break;
+        }
+        atomic_min(&slot_first[s], i);
+    }
+
+    // Replace the first occurrence of each edge with the combined edge, and drop the rest
+    int64_t num_chunks = get_num_chunks();
+    pvector<int64_t> chunk_begin(num_chunks);
+    pvector<int64_t> chunk_size(num_chunks);
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        chunk_begin[c] = n * c / num_chunks;
+        int64_t out = chunk_begin[c];
+        for (int64_t i = chunk_begin[c]; i < n * (c+1) / num_chunks; ++i) {
+            int64_t s = edge_slot[i];
+            if (slot_first[s] != i) { continue; }
+            Edge combined = begin_iter[i];
+            combined.weight = slot_weight[s];
+            combined.timestamp = slot_time[s];
+            begin_iter[out++] = combined;
+        }
+        chunk_size[c] = out - chunk_begin[c];
+    }
+    end_iter = close_chunk_gaps(begin_iter, chunk_begin, chunk_size);
+}
+
+void
+Batch::dedup_and_sort_by_out_degree(const EdgeAggregation& aggregation)
+{
+    dedup(aggregation);
+    sort_by_out_degree();
+}
+
+void
+Batch::sort_by_out_degree()
+{
+    // Count the out-degree of each source vertex from the run boundaries of the sorted edge list
+    // This way the cost depends on the size of the batch, not on the range of vertex ID's
+    pvector<int64_t> offsets = find_source_offsets(begin_iter, size());
+    int64_t num_sources = static_cast<int64_t>(offsets.size()) - 1;
+    pvector<int64_t> sources(num_sources);
+    pvector<int64_t> degrees(num_sources);
+    #pragma omp parallel for
+    for (int64_t i = 0; i < num_sources; ++i) {
+        sources[i] = begin_iter[offsets[i]].src;
+        degrees[i] = offsets[i+1] - offsets[i];
+    }
+    // Vertices that don't appear as a source in this batch have an out-degree of zero
+    // When the ID's are dense enough, look degrees up in a table instead of searching the sources
+    int64_t table_size = num_sources == 0 ? 0 : sources[num_sources - 1] + 1;
+    if (table_size > static_cast<int64_t>(size()) * 2) { table_size = 0; }
+    pvector<int64_t> degree_table(table_size);
+    #pragma omp parallel for
+    for (int64_t v = 0; v < table_size; ++v) { degree_table[v] = 0; }
+    #pragma omp parallel for
+    for (int64_t i = 0; i < (table_size > 0 ? num_sources : 0); ++i) { degree_table[sources[i]] = degrees[i]; }
+    auto degree_of = [&sources, &degrees, &degree_table, table_size](int64_t v) -> int64_t {
+        if (table_size > 0) { return v < table_size ? degree_table[v] : 0; }
+        auto pos = std::lower_bound(sources.begin(), sources.end(), v);
+        return (pos != sources.end() && *pos == v) ? degrees[pos - sources.begin()] : 0;
     };
-    std::sort(begin_iter, end_iter, by_src_dest_time);
 
-    // Deduplicate the edge list
-    {
-        pvector<Edge> deduped_edges(size());
-        // Using std::unique_copy since there is no parallel version of std::unique
-        auto end = std::unique_copy(begin_iter, end_iter, deduped_edges.begin(),
-            // We consider only source and dest when searching for duplicates
-            // The input is sorted, so we'll only get the most recent timestamp
-            // BUG: Does not combine weights
-            [](const Edge& a, const Edge& b) { return a.src == b.src && a.dst == b.dst; });
-        // Copy deduplicated edges back into this batch
-        std::transform(deduped_edges.begin(), end, begin_iter,
-            [](const Edge& e) { return e; });
-        // Adjust size
-        size_t num_deduped_edges = (end - deduped_edges.begin());
-        end_iter = begin_iter + num_deduped_edges;
-    }
-
-    // Allocate an array with an entry for each vertex
-    pvector<int64_t> degrees(this->max_vertex_id()+1);
+    // Each source's edges are already one run, so only the sources need a full sort:
+    // by out degree descending, then by ID, which is the order they are in now
+    pvector<int64_t> order(num_sources);
     #pragma omp parallel for
-    for (size_t i = 0; i < degrees.size(); ++i) {
-        degrees[i] = i;
+    for (int64_t i = 0; i < num_sources; ++i) { order[i] = i; }
+    std::sort(order.begin(), order.end(), [&degrees](int64_t a, int64_t b) {
+        return (degrees[a] != degrees[b]) ? degrees[a] > degrees[b] : a < b;
+    });
+    pvector<int64_t> sorted_offsets(num_sources + 1);
+    sorted_offsets[0] = 0;
+    for (int64_t k = 0; k < num_sources; ++k) {
+        sorted_offsets[k+1] = sorted_offsets[k] + degrees[order[k]];
     }
 
-    // Count the degree of each vertex
-    auto pos = begin_iter;
-    #pragma omp parallel for schedule(static) firstprivate(pos)
-    for (int64_t src = 0; src < degrees.size(); ++src)
+    // Copy each run into place, ordering its destinations by out degree descending, then by ID
+    pvector<Edge> sorted(size());
+    #pragma omp parallel
     {
-        // Find the range of edges with src==src
-        Edge key = {static_cast<int64_t>(src), 0, 0, 0};
-        auto range = std::equal_range(pos, end_iter, key,
-            [](const Edge& a, const Edge& b) {
-                return a.src < b.src;
+        std::vector<DegreeKeyedEdge> scratch;
+        #pragma omp for schedule(dynamic, 64)
+        for (int64_t k = 0; k < num_sources; ++k) {
+            int64_t i = order[k];
+            int64_t degree = degrees[i];
+            scratch.resize(degree);
+            for (int64_t j = 0; j < degree; ++j) {
+                const Edge& e = begin_iter[offsets[i] + j];
+                scratch[j] = {degree, degree_of(e.dst), e};
             }
-        );
-        // Calculate length of range
-        // Since there are no duplicates, this is the degree of src
-        degrees[src] = range.second - range.first;
-        // Reuse end of range as start of next search
-        pos = range.second;
+            std::sort(scratch.begin(), scratch.end(),
+                [](const DegreeKeyedEdge& a, const DegreeKeyedEdge& b) {
+                    return (a.dst_degree != b.dst_degree) ? a.dst_degree > b.dst_degree : a.edge.dst < b.edge.dst;
+                }
+            );
+            for (int64_t j = 0; j < degree; ++j) {
+                sorted[sorted_offsets[k] + j] = scratch[j].edge;
+            }
+        }
     }
+    #pragma omp parallel for
+    for (int64_t i = 0; i < static_cast<int64_t>(size()); ++i) {
+        begin_iter[i] = sorted[i];
+    }
+}
 
-    // Sort by out degree descending, src then dst
-    auto by_out_degree = [&degrees](const Edge& a, const Edge& b) {
-        if (degrees[a.src] != degrees[b.src]) {
-            return degrees[a.src] > degrees[b.src];
-        } else {
-            return degrees[a.dst] > degrees[b.dst];
+void
+Batch::sort_by_degree_bucket()
+{
+    // Each source vertex falls into the bucket floor(log2(out degree))
+    pvector<int64_t> offsets = find_source_offsets(begin_iter, size());
+    int64_t num_sources = static_cast<int64_t>(offsets.size()) - 1;
+    pvector<BucketKeyedEdge> keyed_edges(size());
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int64_t i = 0; i < num_sources; ++i) {
+        int64_t bucket = 63 - __builtin_clzll(offsets[i+1] - offsets[i]);
+        for (int64_t j = offsets[i]; j < offsets[i+1]; ++j) {
+            keyed_edges[j] = {bucket, begin_iter[j]};
         }
-    };
-    std::sort(begin_iter, end_iter, by_out_degree);
+    }
+
+    // Order buckets by degree descending, keeping src and dst order within each bucket
+    std::stable_sort(keyed_edges.begin(), keyed_edges.end(),
+        [](const BucketKeyedEdge& a, const BucketKeyedEdge& b) { return a.bucket > b.bucket; });
+    std::transform(keyed_edges.begin(), keyed_edges.end(), begin_iter,
+        [](const BucketKeyedEdge& k) { return k.edge; });
+}
+
+ConcreteBatch::ConcreteBatch(const Batch& batch, size_t capacity)
+: ConcreteBatch(batch.size(), capacity)
+{
+    directed = batch.is_directed();
+    const Edge* src = batch.begin();
+    #pragma omp parallel for
+    for (size_t i = 0; i < batch.size(); ++i) {
+        begin_iter[i] = src[i];
+    }
+}
+
+void
+ConcreteBatch::symmetrize()
+{
+    // Move the edges to the front of the buffer, then grow it to hold the reverse edges
+    // resize only reallocates if the batch was created without enough capacity
+    size_t n = size();
+    if (begin_iter != edges.begin()) {
+        std::memmove(edges.begin(), begin_iter, n * sizeof(Edge));
+    }
+    edges.resize(n);
+    edges.resize(n * 2);
+    Edge* reversed_end = reverse_edges(edges.begin(), n, edges.begin() + n);
+    edges.resize(reversed_end - edges.begin());
+    begin_iter = edges.begin();
+    end_iter = edges.end();
+    directed = false;
+}
+
+GroupedBatch::GroupedBatch(const Batch& batch) : ConcreteBatch(batch) {}
+
+GroupedBatch::GroupedBatch(const Batch& batch, size_t capacity) : ConcreteBatch(batch, capacity) {}
+
+void
+GroupedBatch::index_sources()
+{
+    pvector<int64_t> run_offsets = find_source_offsets(begin_iter, size());
+    int64_t num_runs = static_cast<int64_t>(run_offsets.size()) - 1;
+    pvector<int64_t> run_sources(num_runs);
+    #pragma omp parallel for
+    for (int64_t i = 0; i < num_runs; ++i) {
+        run_sources[i] = begin_iter[run_offsets[i]].src;
+    }
+    offsets.swap(run_offsets);
+    sources.swap(run_sources);
+}
+
+PartitionedBatch::PartitionedBatch(const Batch& batch, const VertexPartition& mapping)
+: GroupedBatch(batch.size(), false), mapping(mapping), partition_offsets(mapping.num_nodes + 1)
+{
+    directed = batch.is_directed();
+    const Edge* input = batch.begin();
+    int64_t num_edges = batch.size();
+    int64_t num_nodes = mapping.num_nodes;
+
+    // Count the edges in each chunk of the input that belong to each partition
+    int64_t num_chunks = get_num_chunks();
+    pvector<int64_t> chunk_offsets(num_nodes * num_chunks);
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        std::vector<int64_t> counts(num_nodes, 0);
+        for (int64_t i = num_edges * c / num_chunks; i < num_edges * (c+1) / num_chunks; ++i) {
+            counts[mapping.owner(input[i].src)] += 1;
+        }
+        for (int64_t node = 0; node < num_nodes; ++node) {
+            chunk_offsets[node * num_chunks + c] = counts[node];
+        }
+    }
+    // Prefix sum gives the position of each chunk's edges within each partition
+    int64_t total = 0;
+    for (int64_t node = 0; node < num_nodes; ++node) {
+        partition_offsets[node] = total;
+        for (int64_t c = 0; c < num_chunks; ++c) {
+            int64_t count = chunk_offsets[node * num_chunks + c];
+            chunk_offsets[node * num_chunks + c] = total;
+            total += count;
+        }
+    }
+    partition_offsets[num_nodes] = total;
+
+    // Copy each partition using only the threads of its own node
+    #pragma omp parallel
+    {
+        int64_t thread_id = 0;
+        int64_t num_threads = 1;
+#if defined(_OPENMP)
+        thread_id = omp_get_thread_num();
+        num_threads = omp_get_num_threads();
+#endif
+        for (int64_t node = 0; node < num_nodes; ++node) {
+            // Inverse of get_thread_node. With fewer threads than nodes, some threads fill more than one partition
+            int64_t first = (node * num_threads + num_nodes - 1) / num_nodes;
+            int64_t last = ((node + 1) * num_threads + num_nodes - 1) / num_nodes;
+            if (first == last) { first = node % num_threads; last = first + 1; }
+            if (thread_id < first || thread_id >= last) { continue; }
+
+            for (int64_t c = thread_id - first; c < num_chunks; c += last - first) {
+                Edge* out = begin_iter + chunk_offsets[node * num_chunks + c];
+                for (int64_t i = num_edges * c / num_chunks; i < num_edges * (c+1) / num_chunks; ++i) {
+                    if (mapping.owner(input[i].src) == node) { *out++ = input[i]; }
+                }
+            }
+        }
+    }
+}
+
+int64_t
+PartitionedBatch::get_thread_node() const
+{
+#if defined(_OPENMP)
+    return omp_get_thread_num() * mapping.num_nodes / omp_get_num_threads();
+#else
+    return 0;
+#endif
 }
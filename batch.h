@@ -3,23 +3,43 @@
 #include "edge.h"
 #include "range.h"
 #include "pvector.h"
+#include "batch_pool.h"
 #include <cinttypes>
+#include <algorithm>
 
 namespace DynoGraph {
 
 // Represents a list of edges that should be inserted into the graph
 class Batch : public Range<Edge>
 {
-
+protected:
+    // False if the batch holds both directions of every edge
+    bool directed = true;
 public:
     using Range<Edge>::Range;
     Batch() = default;
     int64_t num_vertices_affected() const;
     int64_t max_vertex_id() const;
     void filter(int64_t threshold);
-    void dedup_and_sort_by_out_degree();
+    // Sort by src and dst, then combine duplicate edges
+    void dedup(const EdgeAggregation& aggregation = EdgeAggregation());
+    // Combine duplicate edges in a batch that is already sorted by src and dst,
+    // dropping combined edges with a timestamp older than threshold
+    void combine_sorted_duplicates(int64_t threshold, const EdgeAggregation& aggregation = EdgeAggregation());
+    // Combine duplicate edges without sorting, using a parallel hash table
+    // Each combined edge takes the place of the first occurrence, so the batch keeps its order
+    void aggregate_duplicates(const EdgeAggregation& aggregation = EdgeAggregation());
+    // Sort a deduplicated batch by out degree descending
+    // The batch must be sorted by src and dst, so that only the sources and each source's own edges need sorting
+    void sort_by_out_degree();
+    // Sort a deduplicated batch into buckets of similar out degree (powers of two), largest first
+    // Edges stay sorted by src and dst within each bucket
+    void sort_by_degree_bucket();
+    void dedup_and_sort_by_out_degree(const EdgeAggregation& aggregation = EdgeAggregation());
 
-    bool is_directed() const { return true; }
+    // Returns false if the batch has been symmetrized for an undirected graph
+    bool is_directed() const { return directed; }
+    void set_directed(bool is_directed) { directed = is_directed; }
     virtual ~Batch() = default;
 };
 
@@ -41,17 +61,101 @@ class ConcreteBatch : public Batch
 {
 protected:
     pvector<Edge> edges;
-    ConcreteBatch(size_t n) : Batch(), edges(n) {};
-public:
-    explicit ConcreteBatch(const Batch& batch)
-    : Batch(batch)
-    // Make a copy of the original batch
-    , edges(batch.begin(), batch.end())
+    // False if the storage was allocated fresh, and shouldn't go back to the BatchPool
+    bool pooled;
+    // Allocate storage for n edges. If pooled is false, the buffer is always newly allocated and untouched,
+    // so the pages go wherever the caller first writes them.
+    ConcreteBatch(size_t n, size_t capacity, bool pooled) : Batch(), pooled(pooled)
     {
-        // Reinitialize the batch pointers to point to the owned copy
+        if (pooled) {
+            BatchPool::get_instance().acquire(edges, std::max(n, capacity));
+        } else {
+            pvector<Edge> fresh(std::max(n, capacity));
+            edges.swap(fresh);
+        }
+        edges.resize(n);
         begin_iter = &*edges.begin();
         end_iter = &*edges.end();
     }
+public:
+    // Allocate storage for n edges, to be filled in by the caller
+    // Reserves room for capacity edges, so the batch can grow in place
+    // Storage is taken from the BatchPool, and returned to it when the batch is destroyed
+    explicit ConcreteBatch(size_t n, size_t capacity = 0) : ConcreteBatch(n, capacity, true) {}
+    // Make a copy of the original batch
+    explicit ConcreteBatch(const Batch& batch) : ConcreteBatch(batch, batch.size()) {}
+    // Make a copy of the original batch, reserving room for capacity edges
+    ConcreteBatch(const Batch& batch, size_t capacity);
+    virtual ~ConcreteBatch() { if (pooled) { BatchPool::get_instance().release(edges); } }
+    // Add the reverse of each edge to the batch, so it can be inserted into an undirected graph
+    // Self loops are not repeated. This happens in place if there is enough capacity.
+    // Call before sorting, so the reversed edges can be deduplicated along with the rest.
+    void symmetrize();
+};
+
+// Batch with an index of where the edges of each source vertex begin and end, like a fragment of a CSR graph
+// The edges of source(i) are edges_from(i). Each source vertex has exactly one group,
+// so threads can take ownership of source vertices and insert their edges without locking.
+class GroupedBatch : public ConcreteBatch
+{
+protected:
+    pvector<int64_t> sources;
+    pvector<int64_t> offsets;
+    // Allocate storage for n edges, to be filled in by a subclass
+    GroupedBatch(size_t n, bool pooled) : ConcreteBatch(n, 0, pooled) {}
+public:
+    // Make a copy of the batch. The index is empty until index_sources is called.
+    explicit GroupedBatch(const Batch& batch);
+    // Make a copy of the batch, reserving room for capacity edges
+    GroupedBatch(const Batch& batch, size_t capacity);
+    // Build the index. Edges must be grouped by source vertex, as they are after any of the batch sorts.
+    void index_sources();
+    // Returns the number of distinct source vertices in the batch
+    int64_t num_sources() const { return static_cast<int64_t>(sources.size()); }
+    // Returns the ID of the i'th source vertex
+    int64_t source(int64_t i) const { return sources[i]; }
+    // Returns the edges of the i'th source vertex
+    Batch edges_from(int64_t i) const { return Batch(begin_iter + offsets[i], begin_iter + offsets[i+1]); }
+};
+
+// Assigns each vertex to the NUMA node that owns its data
+struct VertexPartition
+{
+    // Number of NUMA nodes
+    int64_t num_nodes;
+    // Largest vertex ID in the dataset
+    int64_t max_vertex_id;
+    // If true, vertices are assigned to nodes round-robin. Otherwise each node owns a contiguous block.
+    bool cyclic;
+    int64_t owner(int64_t v) const
+    {
+        // Widen before multiplying, so large vertex ID's can't overflow
+        return cyclic ? v % num_nodes
+                      : static_cast<int64_t>(static_cast<__int128>(v) * num_nodes / (max_vertex_id + 1));
+    }
+};
+
+// Batch split into one partition per NUMA node, by the owner of each edge's source vertex
+// Threads are assumed to be spread across nodes in contiguous groups by thread ID (i.e. OMP_PROC_BIND=spread).
+// Each partition is written by the threads of its own node, so first touch places it in that node's memory.
+// For that to work the storage must be untouched, so it never comes from (or goes back to) the BatchPool.
+// Edges keep their original order within each partition, so a sorted batch stays grouped by source.
+class PartitionedBatch : public GroupedBatch
+{
+protected:
+    VertexPartition mapping;
+    pvector<int64_t> partition_offsets;
+public:
+    PartitionedBatch(const Batch& batch, const VertexPartition& mapping);
+    int64_t num_partitions() const { return mapping.num_nodes; }
+    const VertexPartition& get_mapping() const { return mapping; }
+    // Returns the edges whose source vertex is owned by the node
+    Batch partition(int64_t node) const
+    {
+        return Batch(begin_iter + partition_offsets[node], begin_iter + partition_offsets[node+1]);
+    }
+    // Returns the node that the calling thread runs on, according to its thread ID
+    int64_t get_thread_node() const;
 };
 
-} // end namespace DynoGraph
\ No newline at end of file
+} // end namespace DynoGraph
@@ -0,0 +1,59 @@
+#include "batch_pool.h"
+#include <algorithm>
+
+using namespace DynoGraph;
+
+void
+BatchPool::acquire(pvector<Edge> &buffer, size_t n)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Pick the smallest free buffer that can hold n edges
+        auto best = free_buffers.end();
+        for (auto it = free_buffers.begin(); it != free_buffers.end(); ++it) {
+            if (it->capacity() >= n && (best == free_buffers.end() || it->capacity() < best->capacity())) {
+                best = it;
+            }
+        }
+        if (best != free_buffers.end()) {
+            buffer.swap(*best);
+            best->swap(free_buffers.back());
+            free_buffers.pop_back();
+            buffer.resize(n);
+            return;
+        }
+    }
+    // Nothing big enough, allocate a new buffer
+    pvector<Edge> fresh(n);
+    buffer.swap(fresh);
+}
+
+void
+BatchPool::release(pvector<Edge> &buffer)
+{
+    if (buffer.capacity() == 0) { return; }
+    pvector<Edge> empty;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        free_buffers.emplace_back();
+        free_buffers.back().swap(buffer);
+        // When the pool is full, free the smallest buffer outside the lock
+        if (free_buffers.size() > max_free_buffers) {
+            auto smallest = std::min_element(free_buffers.begin(), free_buffers.end(),
+                [](const pvector<Edge>& a, const pvector<Edge>& b) { return a.capacity() < b.capacity(); });
+            smallest->swap(empty);
+            smallest->swap(free_buffers.back());
+            free_buffers.pop_back();
+        }
+    }
+}
+
+void
+BatchPool::clear()
+{
+    std::vector<pvector<Edge>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.swap(free_buffers);
+    }
+}
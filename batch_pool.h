@@ -0,0 +1,38 @@
+#pragma once
+
+#include "edge.h"
+#include "pvector.h"
+#include <mutex>
+#include <vector>
+
+namespace DynoGraph {
+
+// Keeps the edge buffers of batches that have been freed, so the next batch can reuse them
+// Reused buffers have already been faulted in, so filling them doesn't pay for page faults,
+// and the resident set stays flat from one batch to the next.
+class BatchPool
+{
+protected:
+    std::mutex mutex;
+    // Buffers that are ready to be reused
+    std::vector<pvector<Edge>> free_buffers;
+    // Maximum number of buffers to hold on to, larger buffers are kept first
+    size_t max_free_buffers;
+    BatchPool() : max_free_buffers(8) {}
+public:
+    // Fill in buffer with storage for n edges, reusing a free buffer if there is one large enough
+    // Previous contents of the buffer are discarded
+    void acquire(pvector<Edge> &buffer, size_t n);
+    // Return the buffer's storage to the pool. The buffer is left empty.
+    void release(pvector<Edge> &buffer);
+    // Free all the buffers in the pool
+    void clear();
+    // Singleton getter
+    static BatchPool& get_instance()
+    {
+        static BatchPool instance;
+        return instance;
+    }
+};
+
+} // end namespace DynoGraph
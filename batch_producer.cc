@@ -0,0 +1,56 @@
+#include "batch_producer.h"
+#include <chrono>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+using namespace DynoGraph;
+
+BatchProducer::BatchProducer(std::function<PreparedBatch(int64_t)> prepare,
+    int64_t first_batch_id, int64_t end_batch_id, int64_t num_threads)
+: prepare(prepare)
+, stopping(false)
+, stall_time(0)
+, thread(&BatchProducer::produce, this, first_batch_id, end_batch_id, num_threads)
+{}
+
+void
+BatchProducer::produce(int64_t first_batch_id, int64_t end_batch_id, int64_t num_threads)
+{
+#if defined(_OPENMP)
+    // Thread count is per-thread state, so this leaves the insertion threads alone
+    omp_set_num_threads(static_cast<int>(num_threads));
+#endif
+    for (int64_t batch_id = first_batch_id; batch_id < end_batch_id; ++batch_id)
+    {
+        std::unique_ptr<PreparedBatch> prepared(new PreparedBatch(prepare(batch_id)));
+        std::unique_lock<std::mutex> lock(mutex);
+        slot_changed.wait(lock, [this]() { return !slot || stopping; });
+        if (stopping) { return; }
+        slot = std::move(prepared);
+        slot_changed.notify_all();
+    }
+}
+
+PreparedBatch
+BatchProducer::take()
+{
+    auto wait_start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    slot_changed.wait(lock, [this]() { return static_cast<bool>(slot); });
+    PreparedBatch prepared = *slot;
+    slot.reset();
+    slot_changed.notify_all();
+    stall_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - wait_start).count();
+    return prepared;
+}
+
+BatchProducer::~BatchProducer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    slot_changed.notify_all();
+    thread.join();
+}
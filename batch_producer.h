@@ -0,0 +1,58 @@
+#pragma once
+
+#include "batch.h"
+#include "batch_stats.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace DynoGraph {
+
+// A batch that is ready to be applied to the graph
+struct PreparedBatch
+{
+    std::shared_ptr<Batch> batch;
+    // Edges that fell out of the window, or null if the dataset can't list them
+    std::shared_ptr<Batch> expired;
+    // Summary of the batch, if batch stats were requested and have been computed
+    std::shared_ptr<BatchStats> stats;
+    // Edges older than this were left out of the batch, and fall out of the window with it
+    int64_t threshold;
+    // Seconds spent preprocessing the batch
+    double preprocess_time;
+};
+
+// Prepares batches in order on a single long-lived thread, so the next batch is ready while the current
+// one is inserted. Finished batches wait in a one-slot queue, so the producer stays at most one batch ahead.
+// Keeping the same thread for the whole run lets OpenMP reuse its thread team from batch to batch.
+class BatchProducer
+{
+private:
+    std::function<PreparedBatch(int64_t)> prepare;
+    std::mutex mutex;
+    std::condition_variable slot_changed;
+    // The next batch, once it is ready
+    std::unique_ptr<PreparedBatch> slot;
+    // Set when the consumer is done, so the producer doesn't wait on a slot that will never be emptied
+    bool stopping;
+    // Seconds the consumer spent waiting for batches
+    double stall_time;
+    // Started last, once everything it uses is initialized
+    std::thread thread;
+    void produce(int64_t first_batch_id, int64_t end_batch_id, int64_t num_threads);
+public:
+    // Starts preparing batches [first_batch_id, end_batch_id), using num_threads OpenMP threads for each
+    BatchProducer(std::function<PreparedBatch(int64_t)> prepare,
+        int64_t first_batch_id, int64_t end_batch_id, int64_t num_threads);
+    // Waits for the next batch and takes it out of the queue
+    // Must not be called more times than there are batches
+    PreparedBatch take();
+    // Total seconds spent waiting in take()
+    double get_stall_time() const { return stall_time; }
+    // Stops the producer once it finishes the batch it is working on
+    ~BatchProducer();
+};
+
+} // end namespace DynoGraph
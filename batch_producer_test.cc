@@ -0,0 +1,59 @@
+// Provides unit tests for the BatchProducer class
+
+#include "batch_producer.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace DynoGraph;
+
+namespace {
+
+// Stands in for a preprocessed batch, recording which batch it was in the threshold
+PreparedBatch
+fake_batch(int64_t batch_id)
+{
+    PreparedBatch prepared;
+    prepared.threshold = batch_id;
+    prepared.preprocess_time = 0;
+    return prepared;
+}
+
+} // end anonymous namespace
+
+// Batches should come out in order, each prepared exactly once
+TEST(BatchProducerTest, TakesBatchesInOrder)
+{
+    std::atomic<int64_t> num_prepared(0);
+    BatchProducer producer([&](int64_t batch_id) { num_prepared += 1; return fake_batch(batch_id); }, 3, 20, 1);
+    for (int64_t batch_id = 3; batch_id < 20; ++batch_id) {
+        EXPECT_EQ(producer.take().threshold, batch_id);
+    }
+    EXPECT_EQ(num_prepared, 17);
+    EXPECT_GE(producer.get_stall_time(), 0);
+}
+
+// The producer should stay at most one batch ahead of the consumer, besides the one it is working on
+TEST(BatchProducerTest, StaysOneBatchAhead)
+{
+    std::atomic<int64_t> num_prepared(0);
+    BatchProducer producer([&](int64_t batch_id) { num_prepared += 1; return fake_batch(batch_id); }, 0, 100, 1);
+    EXPECT_EQ(producer.take().threshold, 0);
+    // Wait for the producer to fill the slot and prepare one more, which it has to hold on to
+    for (int i = 0; i < 5000 && num_prepared < 3; ++i) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+    EXPECT_EQ(num_prepared, 3);
+    EXPECT_EQ(producer.take().threshold, 1);
+}
+
+// Stopping early shouldn't leave the producer waiting on a slot that will never be emptied
+TEST(BatchProducerTest, StopsEarly)
+{
+    std::vector<int64_t> prepared;
+    {
+        BatchProducer producer([&](int64_t batch_id) { prepared.push_back(batch_id); return fake_batch(batch_id); }, 0, 100, 1);
+        EXPECT_EQ(producer.take().threshold, 0);
+    }
+    EXPECT_LE(prepared.size(), 3);
+}
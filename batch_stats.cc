@@ -0,0 +1,125 @@
+#include "batch_stats.h"
+#include "pvector.h"
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+using namespace DynoGraph;
+
+namespace {
+
+// Set of vertex ID's that threads can add to concurrently, for when a bitmap of the ID space would be too large
+class VertexSet
+{
+private:
+    pvector<int64_t> table;
+    uint64_t mask;
+public:
+    // Room for n vertices, with the table at most half full
+    explicit VertexSet(int64_t n)
+    {
+        uint64_t num_slots = 1;
+        while (num_slots < static_cast<uint64_t>(2 * n)) { num_slots *= 2; }
+        pvector<int64_t>(num_slots, -1).swap(table);
+        mask = num_slots - 1;
+    }
+    // Returns true if the vertex wasn't in the set yet
+    bool insert(int64_t v)
+    {
+        uint64_t s = (static_cast<uint64_t>(v) * 0x9E3779B97F4A7C15ULL) & mask;
+        while (true) {
+            int64_t owner = __atomic_load_n(&table[s], __ATOMIC_RELAXED);
+            // On failure, owner is updated to the vertex that claimed the slot first
+            if (owner == -1 && __atomic_compare_exchange_n(&table[s], &owner, v, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                return true;
+            }
+            if (owner == v) { return false; }
+            s = (s + 1) & mask;
+        }
+    }
+};
+
+} // end anonymous namespace
+
+BatchStats::BatchStats(const Batch& batch, int64_t dataset_max_vertex_id, const Batch* window)
+: max_vertex_id(0)
+, num_vertices(0)
+, num_edges(0)
+, degree_skew(0)
+, timestamp_span(0)
+, existing_edge_fraction(0)
+{
+    int64_t n = static_cast<int64_t>(batch.size());
+    if (n == 0) { return; }
+
+    // Counting distinct edges and degrees requires the edges to be grouped by source
+    // Batches from the sorted modes already are, so only unsorted batches pay for a sorted copy
+    pvector<Edge> sorted;
+    const Edge* edges = batch.begin();
+    const GroupedBatch* grouped_batch = dynamic_cast<const GroupedBatch*>(&batch);
+    bool grouped = (grouped_batch && grouped_batch->num_sources() > 0)
+        || std::is_sorted(batch.begin(), batch.end(), by_src_dst);
+    if (!grouped) {
+        sorted.resize(n);
+        std::copy(batch.begin(), batch.end(), sorted.begin());
+        std::sort(sorted.begin(), sorted.end(), by_src_dst);
+        edges = sorted.begin();
+    }
+
+    // Mark vertices in a bitmap if it would be no larger than a list of the vertex ID's,
+    // otherwise fall back to a hash set sized for the batch
+    int64_t num_words = dataset_max_vertex_id / 64 + 1;
+    bool use_bitmap = num_words <= 2 * n;
+    pvector<uint64_t> bitmap(use_bitmap ? num_words : 0, 0);
+    std::unique_ptr<VertexSet> vertex_set(use_bitmap ? nullptr : new VertexSet(2 * n));
+
+    // Everything is computed in a single pass over the grouped edges
+    // Each thread handles whole runs of a source, so the start of a run walks the rest of it for the degree
+    int64_t max_id = 0;
+    int64_t min_time = std::numeric_limits<int64_t>::max();
+    int64_t max_time = std::numeric_limits<int64_t>::min();
+    int64_t new_vertices = 0;
+    int64_t num_existing = 0;
+    int64_t distinct_edges = 0;
+    int64_t num_sources = 0;
+    int64_t max_degree = 0;
+    #pragma omp parallel for schedule(dynamic, 1024) \
+        reduction(max:max_id, max_time, max_degree) reduction(min:min_time) \
+        reduction(+:new_vertices, num_existing, distinct_edges, num_sources)
+    for (int64_t i = 0; i < n; ++i) {
+        const Edge& e = edges[i];
+        max_id = std::max(max_id, std::max(e.src, e.dst));
+        min_time = std::min(min_time, e.timestamp);
+        max_time = std::max(max_time, e.timestamp);
+
+        // Count each vertex the first time it is marked
+        for (int64_t v : {e.src, e.dst}) {
+            if (use_bitmap) {
+                uint64_t bit = 1ULL << (v % 64);
+                if (!(__atomic_fetch_or(&bitmap[v / 64], bit, __ATOMIC_RELAXED) & bit)) { new_vertices += 1; }
+            } else if (vertex_set->insert(v)) {
+                new_vertices += 1;
+            }
+        }
+
+        if (window && std::binary_search(window->begin(), window->end(), e, by_src_dst)) {
+            num_existing += 1;
+        }
+
+        if (i > 0 && e.src == edges[i-1].src) { continue; }
+        int64_t degree = 0;
+        for (int64_t j = i; j < n && edges[j].src == e.src; ++j) {
+            if (j == i || edges[j].dst != edges[j-1].dst) { ++degree; }
+        }
+        distinct_edges += degree;
+        num_sources += 1;
+        max_degree = std::max(max_degree, degree);
+    }
+
+    max_vertex_id = max_id;
+    timestamp_span = max_time - min_time;
+    num_vertices = new_vertices;
+    existing_edge_fraction = static_cast<double>(num_existing) / n;
+    num_edges = distinct_edges;
+    degree_skew = max_degree / (static_cast<double>(distinct_edges) / num_sources);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "batch.h"
+#include <cinttypes>
+
+namespace DynoGraph {
+
+// Summary statistics describing the contents of a batch
+struct BatchStats
+{
+    // Largest vertex ID in the batch
+    int64_t max_vertex_id;
+    // Number of distinct vertices in the batch
+    int64_t num_vertices;
+    // Number of distinct edges (src, dst) in the batch
+    int64_t num_edges;
+    // Largest out-degree in the batch, divided by the mean out-degree of the source vertices
+    double degree_skew;
+    // Difference between the latest and earliest timestamps in the batch
+    int64_t timestamp_span;
+    // Fraction of the edges in the batch that are already in the window
+    double existing_edge_fraction;
+
+    // Compute stats for the batch
+    // max_vertex_id is the largest vertex ID in the dataset.
+    // window contains the edges currently in the graph, sorted by src and dst (see SnapshotBuilder).
+    // If window is null, existing_edge_fraction is set to zero.
+    BatchStats(const Batch& batch, int64_t max_vertex_id, const Batch* window);
+};
+
+} // end namespace DynoGraph
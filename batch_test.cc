@@ -1,5 +1,8 @@
 #include "batch.h"
+#include "batch_stats.h"
 #include <gtest/gtest.h>
+#include <map>
+#include <random>
 
 using namespace DynoGraph;
 
@@ -106,3 +109,397 @@ TEST(BatchTest, NumVerticesAffected) {
     ASSERT_EQ(batch.num_vertices_affected(), 6);
 }
 
+
+// Vertex ID's far apart shouldn't require storage proportional to the largest ID
+TEST(BatchTest, DedupAndSortSparseVertexIds) {
+    const int64_t big = 1LL << 40;
+    std::vector<Edge> edges = {
+        {big + 7, 1, 1, 100},
+        {5, big + 7, 1, 200},
+        {big + 7, 2, 1, 300},
+        {big + 7, 1, 1, 400},
+    };
+    Batch batch(edges);
+    batch.dedup_and_sort_by_out_degree();
+    ASSERT_EQ(batch.size(), 3);
+    EXPECT_EQ(batch[0].src, big + 7);
+    EXPECT_EQ(batch[0].dst, 1);
+    EXPECT_EQ(batch[1].src, big + 7);
+    EXPECT_EQ(batch[1].dst, 2);
+    EXPECT_EQ(batch[2].src, 5);
+}
+
+// Duplicate edges should be combined the same way the graph would combine them on insert
+TEST(BatchTest, DedupCombinesWeights) {
+    std::vector<Edge> edges = {
+        {2, 3, 1, 100},
+        {1, 2, 4, 150},
+        {2, 3, 2, 300},
+        {2, 3, 5, 200},
+        {1, 2, 1, 120},
+    };
+    Batch batch(edges);
+    batch.dedup_and_sort_by_out_degree();
+    ASSERT_EQ(batch.size(), 2);
+    EXPECT_EQ(batch[0], (Edge{1, 2, 5, 150}));
+    EXPECT_EQ(batch[1], (Edge{2, 3, 8, 300}));
+}
+
+// Sorting run by run should give the same order as sorting every edge on the full degree key
+TEST(BatchTest, SortByOutDegreeMatchesFullSort) {
+    std::mt19937_64 rng(3);
+    // Skewed sources, so there are plenty of ties in degree
+    std::uniform_int_distribution<int64_t> vertex(0, 300);
+    std::vector<Edge> edges(20000);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        int64_t src = vertex(rng) % (1 + vertex(rng));
+        edges[i] = {src, vertex(rng), 1, static_cast<int64_t>(i)};
+    }
+    Batch batch(edges);
+    batch.dedup();
+    std::map<int64_t, int64_t> degree;
+    for (const Edge& e : batch) { degree[e.src] += 1; }
+    std::vector<Edge> expected(batch.begin(), batch.end());
+    std::sort(expected.begin(), expected.end(), [&degree](const Edge& a, const Edge& b) {
+        int64_t a_src = degree[a.src], b_src = degree[b.src];
+        int64_t a_dst = degree.count(a.dst) ? degree[a.dst] : 0, b_dst = degree.count(b.dst) ? degree[b.dst] : 0;
+        return (a_src != b_src) ? a_src > b_src
+             : (a.src != b.src) ? a.src < b.src
+             : (a_dst != b_dst) ? a_dst > b_dst
+             :  a.dst < b.dst;
+    });
+    batch.sort_by_out_degree();
+    ASSERT_EQ(batch.size(), expected.size());
+    EXPECT_TRUE(std::equal(batch.begin(), batch.end(), expected.begin()));
+}
+
+// Check the combined weights and timestamps on a batch large enough to be split across threads
+TEST(BatchTest, DedupLargeBatch) {
+    std::mt19937_64 rng(0);
+    std::uniform_int_distribution<int64_t> vertex(0, 50);
+    std::vector<Edge> edges(20000);
+    std::map<std::pair<int64_t, int64_t>, Edge> expected;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        Edge e = {vertex(rng), vertex(rng), static_cast<int64_t>(i % 7), static_cast<int64_t>(i)};
+        edges[i] = e;
+        auto key = std::make_pair(e.src, e.dst);
+        auto pos = expected.find(key);
+        if (pos == expected.end()) {
+            expected[key] = e;
+        } else {
+            pos->second.weight += e.weight;
+            pos->second.timestamp = std::max(pos->second.timestamp, e.timestamp);
+        }
+    }
+    Batch batch(edges);
+    batch.dedup_and_sort_by_out_degree();
+    ASSERT_EQ(batch.size(), expected.size());
+    for (const Edge& e : batch) {
+        EXPECT_EQ(e, expected[std::make_pair(e.src, e.dst)]);
+    }
+}
+
+// Check each aggregation policy, with and without sorting
+TEST(BatchTest, AggregationPolicies) {
+    typedef EdgeAggregation::WEIGHT WEIGHT;
+    typedef EdgeAggregation::TIME TIME;
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<int64_t> vertex(0, 30);
+    std::uniform_int_distribution<int64_t> weight(1, 100);
+    std::vector<Edge> edges(5000);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        edges[i] = {vertex(rng), vertex(rng), weight(rng), static_cast<int64_t>(i)};
+    }
+
+    for (WEIGHT w : {WEIGHT::SUM, WEIGHT::MAX, WEIGHT::COUNT}) {
+        for (TIME t : {TIME::LAST, TIME::FIRST}) {
+            EdgeAggregation aggregation = {w, t};
+            // Combine the edges one at a time, remembering the order of first occurrence
+            std::map<std::pair<int64_t, int64_t>, Edge> expected;
+            std::vector<std::pair<int64_t, int64_t>> first_seen;
+            for (const Edge& e : edges) {
+                auto key = std::make_pair(e.src, e.dst);
+                auto pos = expected.find(key);
+                if (pos == expected.end()) {
+                    expected[key] = {e.src, e.dst, w == WEIGHT::COUNT ? 1 : e.weight, e.timestamp};
+                    first_seen.push_back(key);
+                    continue;
+                }
+                Edge& c = pos->second;
+                if (w == WEIGHT::SUM) { c.weight += e.weight; }
+                if (w == WEIGHT::MAX) { c.weight = std::max(c.weight, e.weight); }
+                if (w == WEIGHT::COUNT) { c.weight += 1; }
+                if (t == TIME::LAST) { c.timestamp = std::max(c.timestamp, e.timestamp); }
+                if (t == TIME::FIRST) { c.timestamp = std::min(c.timestamp, e.timestamp); }
+            }
+
+            ConcreteBatch sorted((Batch(edges)));
+            sorted.dedup(aggregation);
+            ASSERT_EQ(sorted.size(), expected.size());
+            for (const Edge& e : sorted) {
+                EXPECT_EQ(e, expected[std::make_pair(e.src, e.dst)]);
+            }
+
+            ConcreteBatch hashed((Batch(edges)));
+            hashed.aggregate_duplicates(aggregation);
+            ASSERT_EQ(hashed.size(), expected.size());
+            for (size_t i = 0; i < hashed.size(); ++i) {
+                EXPECT_EQ(hashed[i], expected[first_seen[i]]);
+            }
+        }
+    }
+}
+
+// Vertex ID's spread over a large range use a different counting method
+TEST(BatchTest, NumVerticesAffectedSparse) {
+    const int64_t big = 1LL << 40;
+    std::vector<Edge> edges = {
+        {1, 2, 1, 100},
+        {2, big, 1, 200},
+        {big, 3, 1, 300},
+        {2, 3, 1, 400},
+    };
+    Batch batch(edges);
+    ASSERT_EQ(batch.num_vertices_affected(), 4);
+}
+
+// Make sure the source index points at the edges of each source vertex
+TEST(BatchTest, GroupBySource) {
+    std::vector<Edge> edges = {
+        {4, 1, 1, 100},
+        {2, 3, 1, 200},
+        {4, 2, 1, 300},
+        {2, 3, 1, 400},
+        {7, 4, 1, 500},
+        {4, 3, 1, 600},
+    };
+    GroupedBatch batch((Batch(edges)));
+    batch.dedup_and_sort_by_out_degree();
+    batch.index_sources();
+    ASSERT_EQ(batch.num_sources(), 3);
+    int64_t num_edges = 0;
+    for (int64_t i = 0; i < batch.num_sources(); ++i) {
+        for (const Edge& e : batch.edges_from(i)) {
+            EXPECT_EQ(e.src, batch.source(i));
+            ++num_edges;
+        }
+    }
+    EXPECT_EQ(num_edges, batch.size());
+    EXPECT_EQ(batch.source(0), 4);
+    EXPECT_EQ(batch.edges_from(0).size(), 3);
+}
+
+// Make sure degree buckets come out largest first, with src/dst order inside each bucket
+TEST(BatchTest, SortByDegreeBucket) {
+    std::vector<Edge> edges = {
+        {5, 1, 1, 100},
+        {1, 2, 1, 200},
+        {4, 2, 1, 300},
+        {4, 1, 1, 400},
+        {3, 1, 1, 500},
+        {4, 3, 1, 600},
+        {3, 2, 1, 700},
+        {4, 5, 1, 800},
+    };
+    std::vector<std::pair<int64_t, int64_t>> expected = {
+        {4, 1}, {4, 2}, {4, 3}, {4, 5}, // degree 4
+        {3, 1}, {3, 2},                 // degree 2
+        {1, 2}, {5, 1},                 // degree 1
+    };
+    Batch batch(edges);
+    batch.dedup();
+    batch.sort_by_degree_bucket();
+    ASSERT_EQ(batch.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(batch[i].src, expected[i].first);
+        EXPECT_EQ(batch[i].dst, expected[i].second);
+    }
+}
+
+// Make sure symmetrizing adds each reverse edge once, without repeating self loops
+TEST(BatchTest, Symmetrize) {
+    std::vector<Edge> edges = {
+        {1, 2, 1, 100},
+        {2, 3, 1, 200},
+        {3, 2, 1, 300},
+        {4, 4, 1, 400},
+        {1, 2, 1, 500},
+    };
+    struct ExpectedEdge { int64_t src, dst, weight, timestamp; };
+    std::vector<ExpectedEdge> expected = {
+        {1, 2, 1, 500},
+        {2, 1, 1, 500},
+        {2, 3, 2, 300},
+        {3, 2, 2, 300},
+        {4, 4, 1, 400},
+    };
+    Batch input(edges);
+    GroupedBatch batch(input, input.size() * 2);
+    // The first edge is outside the window
+    batch.filter(200);
+    const Edge* storage = batch.begin() - 1;
+    batch.symmetrize();
+    EXPECT_FALSE(batch.is_directed());
+    EXPECT_EQ(batch.begin(), storage);
+    EXPECT_EQ(batch.size(), 7);
+    batch.dedup();
+    ASSERT_EQ(batch.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(batch[i].src, expected[i].src);
+        EXPECT_EQ(batch[i].dst, expected[i].dst);
+        EXPECT_EQ(batch[i].weight, expected[i].weight);
+        EXPECT_EQ(batch[i].timestamp, expected[i].timestamp);
+    }
+}
+
+// Make sure each partition gets the edges of the vertices its node owns, in their original order
+TEST(BatchTest, PartitionByNumaNode) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int64_t> vertex(0, 99);
+    std::vector<Edge> edges(1000);
+    for (size_t i = 0; i < edges.size(); ++i) {
+        edges[i] = {vertex(rng), vertex(rng), 1, static_cast<int64_t>(i)};
+    }
+    Batch batch(edges);
+
+    for (bool cyclic : {false, true}) {
+        VertexPartition mapping = {3, 99, cyclic};
+        PartitionedBatch partitioned(batch, mapping);
+        ASSERT_EQ(partitioned.size(), batch.size());
+        ASSERT_EQ(partitioned.num_partitions(), 3);
+        for (int64_t node = 0; node < 3; ++node) {
+            std::vector<Edge> expected;
+            std::copy_if(edges.begin(), edges.end(), std::back_inserter(expected),
+                [&](const Edge& e) { return mapping.owner(e.src) == node; });
+            Batch partition = partitioned.partition(node);
+            ASSERT_EQ(partition.size(), expected.size());
+            EXPECT_TRUE(std::equal(partition.begin(), partition.end(), expected.begin()));
+        }
+    }
+    // Block mapping splits the vertex ID's into contiguous ranges
+    VertexPartition block = {3, 99, false};
+    EXPECT_EQ(block.owner(0), 0);
+    EXPECT_EQ(block.owner(33), 0);
+    EXPECT_EQ(block.owner(34), 1);
+    EXPECT_EQ(block.owner(99), 2);
+    // Vertex ID's near the top of the range still land on the last node
+    VertexPartition huge = {4, INT64_MAX - 1, false};
+    EXPECT_EQ(huge.owner(INT64_MAX / 4 - 1), 0);
+    EXPECT_EQ(huge.owner(INT64_MAX / 2), 1);
+    EXPECT_EQ(huge.owner(INT64_MAX - 1), 3);
+}
+
+// Make sure freed batches hand their storage to the next batch that fits in it
+TEST(BatchTest, BatchPoolReusesBuffers) {
+    BatchPool::get_instance().clear();
+    const Edge* storage;
+    {
+        ConcreteBatch batch(1000);
+        storage = batch.begin();
+    }
+    // A smaller batch can reuse the buffer
+    {
+        ConcreteBatch batch(500);
+        EXPECT_EQ(batch.begin(), storage);
+        EXPECT_EQ(batch.size(), 500);
+    }
+    // A larger batch can't, and the buffer stays in the pool for later
+    {
+        ConcreteBatch batch(2000);
+        EXPECT_NE(batch.begin(), storage);
+        ConcreteBatch small_batch(1000);
+        EXPECT_EQ(small_batch.begin(), storage);
+    }
+    BatchPool::get_instance().clear();
+}
+
+// Partitioned batches need untouched pages for NUMA placement, so they stay out of the pool entirely
+TEST(BatchTest, PartitionedBatchSkipsPool) {
+    BatchPool::get_instance().clear();
+    std::vector<Edge> edges = {{1, 2, 1, 100}, {50, 3, 1, 200}, {99, 4, 1, 300}};
+    Batch batch(edges);
+    const Edge* storage;
+    {
+        ConcreteBatch pooled(1000);
+        storage = pooled.begin();
+    }
+    {
+        PartitionedBatch partitioned(batch, {2, 99, false});
+        EXPECT_NE(partitioned.begin(), storage);
+        // The pooled buffer is still there for the next ordinary batch
+        ConcreteBatch reused(500);
+        EXPECT_EQ(reused.begin(), storage);
+    }
+    // Freeing the partitioned batch doesn't hand its buffer to the pool, or this small batch would have taken it
+    {
+        ConcreteBatch fresh(3);
+        EXPECT_EQ(fresh.begin(), storage);
+    }
+    BatchPool::get_instance().clear();
+}
+
+// Make sure batch statistics are computed correctly, with and without a window
+TEST(BatchTest, BatchStats) {
+    std::vector<Edge> edges = {
+        {1, 2, 1, 100},
+        {1, 3, 1, 200},
+        {1, 2, 1, 300},
+        {1, 4, 1, 400},
+        {5, 2, 1, 500},
+    };
+    std::vector<Edge> window_edges = {
+        {1, 3, 1, 50},
+        {5, 2, 1, 60},
+        {6, 7, 1, 70},
+    };
+    Batch batch(edges);
+    Batch window(window_edges);
+
+    BatchStats stats(batch, 10, &window);
+    EXPECT_EQ(stats.max_vertex_id, 5);
+    EXPECT_EQ(stats.num_vertices, 5);
+    EXPECT_EQ(stats.num_edges, 4);
+    // Max degree is 3, mean degree over two sources is 2
+    EXPECT_DOUBLE_EQ(stats.degree_skew, 1.5);
+    EXPECT_EQ(stats.timestamp_span, 400);
+    EXPECT_DOUBLE_EQ(stats.existing_edge_fraction, 0.4);
+
+    // Large ID space, no window
+    BatchStats sparse_stats(batch, 1LL << 40, nullptr);
+    EXPECT_EQ(sparse_stats.num_vertices, 5);
+    EXPECT_EQ(sparse_stats.num_edges, 4);
+    EXPECT_DOUBLE_EQ(sparse_stats.existing_edge_fraction, 0);
+
+    // Batches that are already sorted give the same stats without being copied
+    std::vector<Edge> sorted_edges = edges;
+    std::sort(sorted_edges.begin(), sorted_edges.end(), by_src_dst);
+    Batch sorted_batch(sorted_edges);
+    BatchStats sorted_stats(sorted_batch, 10, &window);
+    EXPECT_EQ(sorted_stats.max_vertex_id, 5);
+    EXPECT_EQ(sorted_stats.num_vertices, 5);
+    EXPECT_EQ(sorted_stats.num_edges, 4);
+    EXPECT_DOUBLE_EQ(sorted_stats.degree_skew, 1.5);
+    EXPECT_EQ(sorted_stats.timestamp_span, 400);
+    EXPECT_DOUBLE_EQ(sorted_stats.existing_edge_fraction, 0.4);
+}
+
+// Stats from the single pass should match the separate full passes over a larger batch
+TEST(BatchTest, BatchStatsMatchFullPasses) {
+    std::mt19937_64 rng(7);
+    for (int64_t max_id : {int64_t(1000), int64_t(1) << 40}) {
+        std::uniform_int_distribution<int64_t> vertex(0, 200);
+        std::vector<Edge> edges(5000);
+        for (size_t i = 0; i < edges.size(); ++i) {
+            // Spread the ID's out over the whole ID space
+            edges[i] = {vertex(rng) * (max_id / 201), vertex(rng) * (max_id / 201) + 1, 1, static_cast<int64_t>(i * 3)};
+        }
+        Batch batch(edges);
+        BatchStats stats(batch, max_id, nullptr);
+        EXPECT_EQ(stats.max_vertex_id, batch.max_vertex_id());
+        EXPECT_EQ(stats.num_vertices, batch.num_vertices_affected());
+        EXPECT_EQ(stats.timestamp_span, 4999 * 3);
+        ConcreteBatch deduped(batch);
+        deduped.dedup();
+        EXPECT_EQ(stats.num_edges, static_cast<int64_t>(deduped.size()));
+    }
+}
@@ -2,6 +2,12 @@
 #include "helpers.h"
 #include "rmat_dataset.h"
 #include "edgelist_dataset.h"
+#include "stream_dataset.h"
+#include <chrono>
+#include <cxxabi.h>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 #ifdef USE_MPI
 #include "proxy_dataset.h"
 #endif
@@ -17,21 +23,330 @@ using std::make_shared;
 using namespace DynoGraph;
 
 Benchmark::Benchmark(Args& args)
+// Load the graph dataset or create a generator based on args
+: Benchmark(args, create_dataset(args))
+{
+}
+
+Benchmark::Benchmark(Args& args, shared_ptr<IDataset> dataset)
 // Save a local copy of the benchmark arguments
 : args(args)
-// Load the graph dataset or create a generator based on args
-, dataset(create_dataset(args))
+, dataset(dataset)
 // Store the max vertex id of the dataset
 , max_vertex_id(dataset->getMaxVertexId())
 // Allocate data for graph algorithms
 , alg_data_manager(max_vertex_id + 1, args.alg_names)
+// Combine duplicate edges in snapshots the same way as in batches
+, snapshot_builder(args.aggregation, !args.snapshot_source_order)
 // Load source vertices, if specified
 , sources(load_sources_from_file(args.sources_path, max_vertex_id))
 // Get a reference to the logger
 , logger(Logger::get_instance())
 // Get a reference to performance hooks
 , hooks(Hooks::getInstance())
-{}
+{
+#ifdef USE_MPI
+    // The producer thread would issue dataset broadcasts out of step with the other ranks
+    if (args.pipeline_threads > 0) {
+        logger << "--pipeline-threads is not supported with MPI\n";
+        die();
+    }
+    // Likewise for the query thread
+    if (args.query_interval_ms > 0) {
+        logger << "--query-interval-ms is not supported with MPI\n";
+        die();
+    }
+#endif
+#if !defined(_OPENMP)
+    if (!args.thread_sweep.empty()) {
+        logger << "--thread-sweep requires a build with OpenMP\n";
+        die();
+    }
+#endif
+    if (args.start_batch >= this->dataset->getNumBatches()) {
+        logger << "Invalid arguments: start batch (" << args.start_batch << ") "
+               << "must be less than the number of batches in the dataset "
+               << "(" << this->dataset->getNumBatches() << ")\n";
+        die();
+    }
+    if (args.sort_once) {
+        logger << "Preprocessing all batches\n";
+        hooks.region_begin("presort");
+        presorted_batches = presort_batches(*dataset, args);
+        hooks.region_end();
+    }
+}
+
+PreparedBatch
+Benchmark::prepare_batch(int64_t batch_id)
+{
+    auto start = std::chrono::steady_clock::now();
+    PreparedBatch prepared;
+    if (!presorted_batches.empty()) {
+        prepared.batch = presorted_batches[batch_id];
+    } else {
+        prepared.batch = get_preprocessed_batch(batch_id, *dataset, args.sort_mode, args.aggregation, args.aggregate);
+        prepared.batch = partition_batch(prepared.batch, max_vertex_id, args);
+    }
+    prepared.threshold = dataset->getTimestampForWindow(batch_id);
+    // Get the list of edges that fell out of the window, if the dataset can provide it
+    if (args.window_size != 1.0) { prepared.expired = get_expired_edges(batch_id, *dataset); }
+    prepared.preprocess_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return prepared;
+}
+
+PreparedBatch
+Benchmark::prepare_coalesced_batch(int64_t first_batch_id, int64_t last_batch_id)
+{
+    auto start = std::chrono::steady_clock::now();
+    // Concatenate the raw batches, then preprocess them together
+    std::vector<shared_ptr<Batch>> batches;
+    size_t total_size = 0;
+    for (int64_t i = first_batch_id; i <= last_batch_id; ++i) {
+        batches.push_back(dataset->getBatch(i));
+        total_size += batches.back()->size();
+    }
+    shared_ptr<ConcreteBatch> combined = make_shared<ConcreteBatch>(total_size);
+    Edge* pos = combined->begin();
+    for (const shared_ptr<Batch>& batch : batches) {
+        pos = std::copy(batch->begin(), batch->end(), pos);
+    }
+
+    PreparedBatch prepared;
+    prepared.threshold = dataset->getTimestampForWindow(last_batch_id);
+    prepared.batch = preprocess_batch(combined, prepared.threshold, dataset->isDirected(),
+        args.sort_mode, args.aggregation, args.aggregate);
+    prepared.batch = partition_batch(prepared.batch, max_vertex_id, args);
+    // Edges that expired over several batches are left to a full scan
+    prepared.preprocess_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return prepared;
+}
+
+void
+Benchmark::describe_batch(PreparedBatch& prepared)
+{
+    // The window is built from the prepared batches rather than read from the dataset a second time,
+    // which would rewind generated datasets and race with the pipeline producer
+    snapshot_builder.expire(prepared.threshold);
+    Batch window = snapshot_builder.get_edges();
+    prepared.stats = make_shared<BatchStats>(*prepared.batch, max_vertex_id, &window);
+    snapshot_builder.add_batch(*prepared.batch, prepared.threshold);
+}
+
+PreparedBatch
+Benchmark::produce_batch(int64_t batch_id)
+{
+    PreparedBatch prepared = prepare_batch(batch_id);
+    // The producer describes every batch in order, so it has the window to itself
+    if (args.batch_stats) { describe_batch(prepared); }
+    return prepared;
+}
+
+shared_ptr<Batch>
+Benchmark::accumulate_batches(int64_t last_batch_id)
+{
+    // Tag each preprocessed edge with the batch it arrived in
+    struct ArrivedEdge { Edge edge; int64_t batch_id; };
+    int64_t num_batches = last_batch_id + 1;
+    std::vector<shared_ptr<Batch>> batches(num_batches);
+    std::vector<int64_t> thresholds(num_batches);
+    std::vector<int64_t> batch_offsets(num_batches + 1, 0);
+    for (int64_t i = 0; i < num_batches; ++i) {
+        batches[i] = presorted_batches.empty()
+            ? get_preprocessed_batch(i, *dataset, args.sort_mode, args.aggregation, args.aggregate)
+            : presorted_batches[i];
+        thresholds[i] = dataset->getTimestampForWindow(i);
+        batch_offsets[i+1] = batch_offsets[i] + static_cast<int64_t>(batches[i]->size());
+    }
+    pvector<ArrivedEdge> arrivals(batch_offsets[num_batches]);
+    for (int64_t i = 0; i < num_batches; ++i) {
+        const Edge* edges = batches[i]->begin();
+        ArrivedEdge* out = arrivals.begin() + batch_offsets[i];
+        #pragma omp parallel for
+        for (int64_t j = 0; j < batch_offsets[i+1] - batch_offsets[i]; ++j) {
+            out[j] = {edges[j], i};
+        }
+        batches[i].reset();
+    }
+
+    // Group the copies of each edge together, in the order they were inserted
+    std::sort(arrivals.begin(), arrivals.end(), [](const ArrivedEdge& a, const ArrivedEdge& b) {
+        if (a.edge.src != b.edge.src) { return a.edge.src < b.edge.src; }
+        if (a.edge.dst != b.edge.dst) { return a.edge.dst < b.edge.dst; }
+        return a.batch_id < b.batch_id;
+    });
+
+    // Replay the copies of each edge against the graph, packing the results at the start of each chunk
+    // Chunk boundaries are moved forward so no edge is split between two chunks
+    auto same_edge = [](const Edge& a, const Edge& b) { return a.src == b.src && a.dst == b.dst; };
+    bool expiring = args.window_size != 1.0;
+    int64_t num_arrivals = static_cast<int64_t>(arrivals.size());
+    int64_t num_chunks = get_num_chunks();
+    std::vector<int64_t> chunk_begin(num_chunks + 1);
+    for (int64_t c = 0; c <= num_chunks; ++c) {
+        int64_t pos = std::max(num_arrivals * c / num_chunks, c > 0 ? chunk_begin[c-1] : 0);
+        while (pos > 0 && pos < num_arrivals && same_edge(arrivals[pos].edge, arrivals[pos-1].edge)) { ++pos; }
+        chunk_begin[c] = pos;
+    }
+    std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t out = chunk_begin[c];
+        for (int64_t i = chunk_begin[c]; i < chunk_begin[c+1];) {
+            Edge current = arrivals[i].edge;
+            for (++i; i < chunk_begin[c+1] && same_edge(arrivals[i].edge, current); ++i) {
+                const ArrivedEdge& next = arrivals[i];
+                if (expiring && current.timestamp < thresholds[next.batch_id]) {
+                    // The edge was deleted before this copy arrived, so it starts over
+                    current = next.edge;
+                } else {
+                    current.weight += next.edge.weight;
+                    current.timestamp = std::max(current.timestamp, next.edge.timestamp);
+                }
+            }
+            if (!expiring || current.timestamp >= thresholds[last_batch_id]) {
+                arrivals[out++].edge = current;
+            }
+        }
+        chunk_offsets[c+1] = out - chunk_begin[c];
+    }
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        chunk_offsets[c+1] += chunk_offsets[c];
+    }
+
+    shared_ptr<ConcreteBatch> prefix = make_shared<ConcreteBatch>(chunk_offsets[num_chunks]);
+    prefix->set_directed(dataset->isDirected());
+    Edge* edges = prefix->begin();
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        for (int64_t i = 0; i < chunk_offsets[c+1] - chunk_offsets[c]; ++i) {
+            edges[chunk_offsets[c] + i] = arrivals[chunk_begin[c] + i].edge;
+        }
+    }
+    return prefix;
+}
+
+void
+Benchmark::set_num_threads(int64_t num_threads)
+{
+    logger << "Running " << args.num_trials << " trial(s) with " << num_threads << " thread(s)\n";
+#if defined(_OPENMP)
+    omp_set_num_threads(static_cast<int>(num_threads));
+#endif
+    hooks.set_attr("num_threads", num_threads);
+    // Start counting region times from zero, leaving out setup and earlier thread counts
+    hooks.take_region_times();
+}
+
+void
+Benchmark::report_thread_scaling(const std::vector<std::map<std::string, double>>& region_times)
+{
+    for (const ThreadScaling& scaling : compute_thread_scaling(args.thread_sweep, region_times, args.num_trials))
+    {
+        logger << scaling.region_name << " with " << scaling.num_threads << " thread(s): "
+               << scaling.region_time_ms << " ms per trial, "
+               << "speedup " << scaling.speedup << ", efficiency " << scaling.efficiency << "\n";
+        // Report the results in an empty region, so they land in the hooks output
+        hooks.set_attr("num_threads", scaling.num_threads);
+        hooks.set_stat("scaled_region", scaling.region_name);
+        hooks.set_stat("region_time_ms", scaling.region_time_ms);
+        hooks.set_stat("speedup", scaling.speedup);
+        hooks.set_stat("efficiency", scaling.efficiency);
+        hooks.region_begin("thread_scaling");
+        hooks.region_end();
+    }
+}
+
+void
+Benchmark::check_graph_sizes(int64_t trial, const std::string& engine)
+{
+    auto reference = reference_graph_sizes.find(trial);
+    if (reference == reference_graph_sizes.end()) {
+        reference_graph_sizes[trial] = std::make_pair(engine, epoch_graph_sizes);
+        return;
+    }
+    const std::string& reference_engine = reference->second.first;
+    const std::vector<GraphSize>& reference_sizes = reference->second.second;
+    if (reference_sizes.size() != epoch_graph_sizes.size()) {
+        logger << "ERROR: " << engine << " ran " << epoch_graph_sizes.size() << " epochs, but "
+               << reference_engine << " ran " << reference_sizes.size() << "\n";
+        die();
+    }
+    bool mismatch = false;
+    for (size_t epoch = 0; epoch < epoch_graph_sizes.size(); ++epoch)
+    {
+        const GraphSize& expected = reference_sizes[epoch];
+        const GraphSize& actual = epoch_graph_sizes[epoch];
+        if (actual.num_vertices != expected.num_vertices || actual.num_edges != expected.num_edges) {
+            logger << "ERROR: at epoch " << epoch << ", " << engine << " has "
+                   << actual.num_vertices << " vertices and " << actual.num_edges << " edges, but "
+                   << reference_engine << " has "
+                   << expected.num_vertices << " vertices and " << expected.num_edges << " edges\n";
+            mismatch = true;
+        }
+    }
+    if (mismatch) { die(); }
+}
+
+void
+QueryControl::stop()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+    stop_requested.notify_all();
+}
+
+int64_t
+Benchmark::run_queries(DynamicGraph& graph, QueryControl& control, LatencyHistogram& latency)
+{
+#if defined(_OPENMP)
+    // Thread count is per-thread state, so this leaves the insertion threads alone
+    omp_set_num_threads(static_cast<int>(args.query_threads));
+#endif
+    using clock = std::chrono::steady_clock;
+    const clock::duration interval = std::chrono::milliseconds(args.query_interval_ms);
+    int64_t num_queries = 0;
+    clock::time_point next_query = clock::now() + interval;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(control.mutex);
+            if (control.stop_requested.wait_until(lock, next_query, [&]() { return control.done; })) { break; }
+        }
+        clock::time_point start = clock::now();
+        for (std::string alg_name : args.alg_names)
+        {
+            // Sources are picked from the graph as it is right now, since it changes between queries
+            std::vector<int64_t> query_sources = args.sources_path.empty()
+                ? graph.get_high_degree_vertices(get_num_sources(alg_name))
+                : sources;
+            graph.update_alg(alg_name, query_sources, alg_data_manager.get_data_for_alg(alg_name));
+        }
+        clock::time_point end = clock::now();
+        latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        num_queries += 1;
+        // A query that overruns the interval delays the next one, rather than queueing up more
+        next_query = std::max(next_query + interval, end);
+    }
+    return num_queries;
+}
+
+std::vector<int64_t>
+Benchmark::get_high_degree_vertices(const DynamicGraph& graph, int64_t n, const Batch* snapshot)
+{
+    auto picked = epoch_sources.find(n);
+    if (picked != epoch_sources.end()) { return picked->second; }
+    std::vector<int64_t> vertices;
+    if (!args.track_sources) {
+        vertices = graph.get_high_degree_vertices(n);
+    } else if (snapshot) {
+        vertices = find_high_degree_vertices(*snapshot, n);
+    } else {
+        vertices = degree_tracker.get_high_degree_vertices(graph, n);
+    }
+    epoch_sources[n] = vertices;
+    return vertices;
+}
 
 shared_ptr<IDataset>
 DynoGraph::create_dataset(const Args &args)
@@ -50,6 +365,16 @@ DynoGraph::create_dataset(const Args &args)
         }
         dataset = make_shared<RmatDataset>(args, rmat_args);
 
+    } else if (has_suffix(args.input_path, ".stream")) {
+        // The suffix ".stream" means input_path describes a pipe or socket to read edges from
+        StreamArgs stream_args(StreamArgs::from_string(args.input_path));
+        std::string msg = stream_args.validate();
+        if (!msg.empty()) {
+            logger << msg;
+            die();
+        }
+        dataset = make_shared<StreamDataset>(args, stream_args);
+
     } else {
         dataset = make_shared<EdgeListDataset>(args);
     }
@@ -61,41 +386,189 @@ DynoGraph::create_dataset(const Args &args)
     return dataset;
 }
 
+namespace {
+
+// Returns a copy of the edges in the batch that are within the window
+// For undirected datasets, the copy is symmetrized in place before it gets sorted
+template<typename BatchType>
+shared_ptr<BatchType>
+copy_batch(shared_ptr<Batch> batch, int64_t threshold, bool directed)
+{
+    batch->filter(threshold);
+    if (directed) {
+        return make_shared<BatchType>(*batch);
+    }
+    shared_ptr<BatchType> copy = make_shared<BatchType>(*batch, batch->size() * 2);
+    copy->symmetrize();
+    return copy;
+}
+
+} // end anonymous namespace
+
 shared_ptr<Batch>
-DynoGraph::get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT_MODE sort_mode)
+DynoGraph::get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT_MODE sort_mode,
+    const EdgeAggregation &aggregation, bool aggregate_unsorted)
 {
     int64_t threshold = dataset.getTimestampForWindow(batchId);
+    if (sort_mode == Args::SORT_MODE::SNAPSHOT) {
+        SnapshotBuilder snapshot(aggregation);
+        return snapshot.get_snapshot(dataset, batchId, threshold);
+    }
+    return preprocess_batch(dataset.getBatch(batchId), threshold, dataset.isDirected(), sort_mode,
+        aggregation, aggregate_unsorted);
+}
 
+shared_ptr<Batch>
+DynoGraph::preprocess_batch(shared_ptr<Batch> batch, int64_t threshold, bool directed, Args::SORT_MODE sort_mode,
+    const EdgeAggregation &aggregation, bool aggregate_unsorted)
+{
     switch (sort_mode)
     {
         case Args::SORT_MODE::UNSORTED:
         {
-            shared_ptr<Batch> batch = dataset.getBatch(batchId);
+            if (aggregate_unsorted) {
+                // Combine duplicates with a hash table, rather than sorting
+                shared_ptr<ConcreteBatch> copy = copy_batch<ConcreteBatch>(batch, threshold, directed);
+                copy->aggregate_duplicates(aggregation);
+                return copy;
+            }
+            if (!directed) {
+                return copy_batch<ConcreteBatch>(batch, threshold, directed);
+            }
             batch->filter(threshold);
             return batch;
         }
         case Args::SORT_MODE::PRESORT:
         {
-            shared_ptr<Batch> batch = make_shared<ConcreteBatch>(
-                    std::move(*dataset.getBatch(batchId))
-            );
-            batch->filter(threshold);
-            batch->dedup_and_sort_by_out_degree();
-            return batch;
+            shared_ptr<GroupedBatch> sorted = copy_batch<GroupedBatch>(batch, threshold, directed);
+            sorted->dedup_and_sort_by_out_degree(aggregation);
+            sorted->index_sources();
+            return sorted;
+        }
+        case Args::SORT_MODE::LOCALITY:
+        {
+            shared_ptr<GroupedBatch> sorted = copy_batch<GroupedBatch>(batch, threshold, directed);
+            sorted->dedup(aggregation);
+            sorted->index_sources();
+            return sorted;
         }
-        case Args::SORT_MODE::SNAPSHOT:
+        case Args::SORT_MODE::HYBRID:
         {
-            shared_ptr<Batch> cumulative_snapshot = make_shared<ConcreteBatch>(
-                    std::move(*dataset.getBatchesUpTo(batchId))
-            );
-            cumulative_snapshot->filter(threshold);
-            cumulative_snapshot->dedup_and_sort_by_out_degree();
-            return cumulative_snapshot;
+            shared_ptr<GroupedBatch> sorted = copy_batch<GroupedBatch>(batch, threshold, directed);
+            sorted->dedup(aggregation);
+            sorted->sort_by_degree_bucket();
+            sorted->index_sources();
+            return sorted;
         }
+        // Snapshots span many batches, so they are built by get_preprocessed_batch
         default: assert(0); return nullptr;
     }
 }
 
+shared_ptr<Batch>
+DynoGraph::get_expired_edges(int64_t batchId, IDataset &dataset)
+{
+    shared_ptr<Batch> expired = dataset.getExpiredEdges(batchId);
+    if (!expired || dataset.isDirected()) { return expired; }
+    // The dataset only lists the direction it was given, but the graph holds both
+    shared_ptr<ConcreteBatch> symmetrized = make_shared<ConcreteBatch>(*expired, expired->size() * 2);
+    symmetrized->symmetrize();
+    return symmetrized;
+}
+
+shared_ptr<Batch>
+DynoGraph::partition_batch(shared_ptr<Batch> batch, int64_t max_vertex_id, const Args &args)
+{
+    if (args.numa_nodes <= 1) { return batch; }
+    VertexPartition mapping = {
+        args.numa_nodes,
+        max_vertex_id,
+        args.numa_mapping == Args::NUMA_MAPPING::CYCLIC
+    };
+    shared_ptr<PartitionedBatch> partitioned = make_shared<PartitionedBatch>(*batch, mapping);
+    // Partitioning keeps the edges of each source together, so sorted batches can be indexed again
+    if (std::dynamic_pointer_cast<GroupedBatch>(batch)) {
+        partitioned->index_sources();
+    }
+    return partitioned;
+}
+
+std::vector<shared_ptr<Batch>>
+DynoGraph::presort_batches(IDataset &dataset, const Args &args)
+{
+    // Fetching is sequential, since generated datasets produce their batches in order
+    // The thresholds are looked up here too, since under MPI every dataset call is a broadcast
+    int64_t num_batches = dataset.getNumBatches();
+    std::vector<shared_ptr<Batch>> batches(num_batches);
+    std::vector<int64_t> thresholds(num_batches);
+    for (int64_t i = 0; i < num_batches; ++i) {
+        batches[i] = dataset.getBatch(i);
+        thresholds[i] = dataset.getTimestampForWindow(i);
+    }
+    bool directed = dataset.isDirected();
+    int64_t max_vertex_id = dataset.getMaxVertexId();
+
+    // Preprocess many small batches side by side; a few large ones are better off using every thread each
+#if defined(_OPENMP)
+    bool across_batches = num_batches >= omp_get_max_threads();
+#endif
+    #pragma omp parallel for schedule(dynamic, 1) if(across_batches)
+    for (int64_t i = 0; i < num_batches; ++i) {
+        batches[i] = preprocess_batch(batches[i], thresholds[i], directed, args.sort_mode,
+            args.aggregation, args.aggregate);
+        batches[i] = partition_batch(batches[i], max_vertex_id, args);
+    }
+
+    dataset.reset();
+    return batches;
+}
+
+std::vector<ThreadScaling>
+DynoGraph::compute_thread_scaling(const std::vector<int64_t>& thread_sweep,
+                                  const std::vector<std::map<std::string, double>>& region_times, int64_t num_trials)
+{
+    assert(region_times.size() == thread_sweep.size());
+    std::vector<ThreadScaling> results;
+    if (region_times.empty()) { return results; }
+    int64_t base_threads = thread_sweep[0];
+    for (auto& base : region_times[0])
+    {
+        const std::string& region_name = base.first;
+        for (size_t i = 0; i < region_times.size(); ++i)
+        {
+            auto time = region_times[i].find(region_name);
+            if (time == region_times[i].end() || time->second <= 0) { continue; }
+            int64_t num_threads = thread_sweep[i];
+            double speedup = base.second / time->second;
+            double efficiency = speedup * base_threads / num_threads;
+            results.push_back({region_name, num_threads, time->second / num_trials, speedup, efficiency});
+        }
+    }
+    return results;
+}
+
+std::string
+DynoGraph::check_fits_dataset(const Args &args, int64_t num_edges)
+{
+    std::ostringstream oss;
+    if (args.batch_size > num_edges) {
+        oss << "\tbatch size (" << args.batch_size << ") cannot be larger than the number of edges "
+            << "in the dataset (" << num_edges << ")\n";
+        return oss.str();
+    }
+    // Rounding down, like the datasets do when slicing their edges into batches
+    int64_t num_batches = num_edges / args.batch_size;
+    if (args.num_epochs > num_batches) {
+        oss << "\tnumber of epochs (" << args.num_epochs << ") cannot be greater than the number of batches "
+            << "(" << num_batches << ")\n";
+    }
+    if (args.start_batch >= num_batches) {
+        oss << "\tstart batch (" << args.start_batch << ") must be less than the number of batches "
+            << "(" << num_batches << ")\n";
+    }
+    return oss.str();
+}
+
 bool
 DynoGraph::enable_algs_for_batch(int64_t batch_id, int64_t num_batches, int64_t num_epochs) {
     bool enable;
@@ -113,6 +586,25 @@ DynoGraph::enable_algs_for_batch(int64_t batch_id, int64_t num_batches, int64_t
     return enable;
 }
 
+std::string
+DynoGraph::demangle(const char* name)
+{
+    int status;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status != 0) { return name; }
+    std::string readable(demangled);
+    free(demangled);
+    return readable;
+}
+
+int64_t
+DynoGraph::get_num_sources(const std::string& alg_name)
+{
+    if (alg_name == "bfs" || alg_name == "sssp") { return 64; }
+    else if (alg_name == "bc") { return 128; }
+    else { return 0; }
+}
+
 std::vector<int64_t>
 DynoGraph::load_sources_from_file(std::string path, int64_t max_vertex_id)
 {
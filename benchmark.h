@@ -9,28 +9,110 @@
 #include <iostream>
 #include <assert.h>
 #include <algorithm>
+#include <map>
+#include <future>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <typeinfo>
 
 #include "args.h"
 #include "idataset.h"
 #include "alg_data_manager.h"
+#include "snapshot_builder.h"
+#include "batch_stats.h"
+#include "batch_producer.h"
+#include "degree_tracker.h"
+#include "replay_clock.h"
 #include "dynamic_graph.h"
 #include "logger.h"
 #include <hooks.h>
+#include <latency_histogram.h>
 
 namespace DynoGraph {
 
 std::shared_ptr<IDataset>
 create_dataset(const Args &args);
 
+// Returns the batch, filtered and sorted according to the sort mode
+// Duplicate edges are combined according to the aggregation policy in every mode but unsorted,
+// where they are only combined if aggregate_unsorted is set
 std::shared_ptr<Batch>
-get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT_MODE sort_mode);
+get_preprocessed_batch(int64_t batchId, IDataset &dataset, Args::SORT_MODE sort_mode,
+    const EdgeAggregation &aggregation = EdgeAggregation(), bool aggregate_unsorted = false);
+
+// Returns the batch, filtered and sorted according to the sort mode, which must not be SNAPSHOT
+std::shared_ptr<Batch>
+preprocess_batch(std::shared_ptr<Batch> batch, int64_t threshold, bool directed, Args::SORT_MODE sort_mode,
+    const EdgeAggregation &aggregation = EdgeAggregation(), bool aggregate_unsorted = false);
+
+// Returns the edges that fell out of the window with the batch, or null if the dataset can't list them
+// For undirected datasets, both directions of each edge are listed, just like in the preprocessed batches
+std::shared_ptr<Batch>
+get_expired_edges(int64_t batchId, IDataset &dataset);
+
+// Splits the batch among the NUMA nodes given in args, for vertex IDs up to max_vertex_id
+std::shared_ptr<Batch>
+partition_batch(std::shared_ptr<Batch> batch, int64_t max_vertex_id, const Args &args);
+
+// Preprocesses and partitions every batch in the dataset up front, then resets the dataset
+std::vector<std::shared_ptr<Batch>>
+presort_batches(IDataset &dataset, const Args &args);
+
+// Returns a description of anything that keeps the configuration from running on a dataset with this many edges,
+// sliced into batches of args.batch_size, or an empty string if it fits
+std::string
+check_fits_dataset(const Args &args, int64_t num_edges);
 
 bool
 enable_algs_for_batch(int64_t batch_id, int64_t num_batches, int64_t num_epochs);
 
+// Returns the number of source vertices to pick for the alg
+int64_t
+get_num_sources(const std::string& alg_name);
+
 std::vector<int64_t>
 load_sources_from_file(std::string path, int64_t max_vertex_id);
 
+// Size of the graph when the algs ran, for comparing engines
+struct GraphSize
+{
+    int64_t num_vertices;
+    int64_t num_edges;
+};
+
+// How well one region scaled at one thread count of a thread sweep
+struct ThreadScaling
+{
+    std::string region_name;
+    int64_t num_threads;
+    // Average time spent in the region per trial
+    double region_time_ms;
+    // Relative to the first thread count in the sweep
+    double speedup;
+    double efficiency;
+};
+
+// Returns the scaling of each region in the first set of region times, given the total time spent in each region
+// at each thread count. Regions that are missing or took no time at a thread count are left out.
+std::vector<ThreadScaling>
+compute_thread_scaling(const std::vector<int64_t>& thread_sweep,
+                       const std::vector<std::map<std::string, double>>& region_times, int64_t num_trials);
+
+// Returns a readable name for a type, e.g. the graph engine being benchmarked
+std::string
+demangle(const char* name);
+
+// Tells the query thread in the concurrent driver when the insertions are finished
+struct QueryControl
+{
+    std::mutex mutex;
+    std::condition_variable stop_requested;
+    bool done;
+
+    QueryControl() : done(false) {}
+    void stop();
+};
 
 class Benchmark {
 
@@ -39,39 +121,165 @@ protected:
     std::shared_ptr<IDataset> dataset;
     int64_t max_vertex_id;
     AlgDataManager alg_data_manager;
+    SnapshotBuilder snapshot_builder;
     std::vector<int64_t> sources;
+    // Every batch, already preprocessed, when the whole dataset is sorted once up front
+    std::vector<std::shared_ptr<Batch>> presorted_batches;
+    // Out-degrees of the vertices in the graph, for picking source vertices in the dynamic driver
+    DegreeTracker degree_tracker;
+    // Source vertices picked so far this epoch, by number of sources
+    std::map<int64_t, std::vector<int64_t>> epoch_sources;
+    // Size of the graph at each epoch of the last trial
+    std::vector<GraphSize> epoch_graph_sizes;
+    // Engine that finished each trial first, and its graph sizes, for checking the other engines against
+    std::map<int64_t, std::pair<std::string, std::vector<GraphSize>>> reference_graph_sizes;
     Logger& logger;
     Hooks& hooks;
 
+    // Preprocesses a batch and fetches the edges that expire with it
+    PreparedBatch prepare_batch(int64_t batch_id);
+    // Preprocesses several consecutive batches together, as if they were a single batch
+    PreparedBatch prepare_coalesced_batch(int64_t first_batch_id, int64_t last_batch_id);
+    // Computes batch stats against the edges still in the window, then adds the batch to the window
+    // Every batch must be described, in order, for the window to stay complete
+    void describe_batch(PreparedBatch& prepared);
+    // Prepares and describes a batch, on the pipeline producer thread
+    PreparedBatch produce_batch(int64_t batch_id);
+    // Returns the edges the graph holds after inserting batches [0, last_batch_id] one at a time,
+    // sorted by src and dst. Each batch is preprocessed as usual, then later copies of an edge add
+    // to its weight and keep the latest timestamp, unless the edge fell out of the window first.
+    std::shared_ptr<Batch> accumulate_batches(int64_t last_batch_id);
+    // Returns the n highest degree vertices, picking them only once per epoch
+    // With --track-sources, they come from the snapshot if one is given, or else from the degree tracker
+    std::vector<int64_t> get_high_degree_vertices(const DynamicGraph& graph, int64_t n, const Batch* snapshot);
+    // Runs the algs every args.query_interval_ms on args.query_threads OpenMP threads until told to stop
+    // Records the time taken by each round of algs, and returns the number of rounds
+    int64_t run_queries(DynamicGraph& graph, QueryControl& control, LatencyHistogram& latency);
+    // Compares the graph sizes from the engine's last trial against the first engine to finish the same trial
+    // Exits on a mismatch, since results from an engine that built the wrong graph can't be compared
+    void check_graph_sizes(int64_t trial, const std::string& engine);
+
 public:
 
     /* Initializes the benchmark, including the graph dataset and other
      * auxiliary data structures for recording results
      */
     Benchmark(Args& args);
+    // Initializes the benchmark with a dataset that is already loaded and configured for args
+    Benchmark(Args& args, std::shared_ptr<IDataset> dataset);
+
+    // Builds the graph from the batches before args.start_batch all at once, using the bulk constructor
+    // Then recomputes each alg from scratch, so the first incremental update starts from the right state
+    template<typename graph_t>
+    graph_t *
+    fast_forward()
+    {
+        int64_t batch_id = args.start_batch - 1;
+        hooks.set_attr("batch", batch_id);
+        logger << "Fast-forwarding through batch " << batch_id << "\n";
+
+        hooks.region_begin("preprocess");
+        std::shared_ptr<DynoGraph::Batch> prefix = accumulate_batches(batch_id);
+        prefix = partition_batch(prefix, max_vertex_id, args);
+        // The snapshot builder keeps the window, so batch stats can pick up from here
+        if (args.batch_stats) {
+            snapshot_builder.update(*dataset, batch_id, dataset->getTimestampForWindow(batch_id));
+        }
+        hooks.region_end();
+
+        hooks.region_begin("construct");
+        graph_t * graph = new graph_t(args, max_vertex_id, *prefix);
+        hooks.region_end();
+        if (args.track_sources) { degree_tracker.insert_batch(*graph, *prefix); }
+
+        // Sources come from the prefix, just like in snapshot mode
+        epoch_sources.clear();
+        for (std::string alg_name : args.alg_names)
+        {
+            if (args.sources_path.empty()) {
+                sources = get_high_degree_vertices(*graph, get_num_sources(alg_name), prefix.get());
+            }
+            logger << "Recomputing " << alg_name << " from scratch\n";
+            hooks.set_stat("alg", alg_name);
+            hooks.set_stat("num_vertices", graph->get_num_vertices());
+            hooks.set_stat("num_edges", graph->get_num_edges());
+            hooks.region_begin("bootstrap");
+            graph->update_alg(alg_name, sources, alg_data_manager.get_data_for_alg(alg_name));
+            hooks.region_end();
+        }
+        alg_data_manager.next_epoch();
+        return graph;
+    }
 
     template<typename graph_t>
     void
     run_dynamic()
     {
         // Initialize the graph data structure
-        graph_t graph(args, max_vertex_id);
+        // With --start-batch, it starts out holding every earlier batch
+        int64_t start_batch = args.start_batch;
+        std::unique_ptr<graph_t> graph_ptr(start_batch > 0
+            ? fast_forward<graph_t>()
+            : new graph_t(args, max_vertex_id));
+        graph_t &graph = *graph_ptr;
+        epoch_graph_sizes.clear();
 
         // Step through one batch at a time
-        // Epoch will be incremented as necessary
+        // Epoch will be incremented as necessary, starting after any epochs that were skipped
         int64_t epoch = 0;
         int64_t num_batches = dataset->getNumBatches();
-        for (int64_t batch_id = 0; batch_id < num_batches; ++batch_id)
+        for (int64_t batch_id = 0; batch_id < start_batch; ++batch_id) {
+            if (enable_algs_for_batch(batch_id, num_batches, args.num_epochs)) { epoch += 1; }
+        }
+
+        // When pipelined, a producer thread prepares the next batch while the current one is inserted
+        bool pipelined = args.pipeline_threads > 0;
+        std::unique_ptr<BatchProducer> producer;
+        if (pipelined) {
+            producer.reset(new BatchProducer([this](int64_t id) { return produce_batch(id); },
+                start_batch, num_batches, args.pipeline_threads));
+        }
+        double total_producer_time = 0;
+
+        // When replaying, batches are released at the times given by their timestamps
+        bool replaying = args.replay_rate > 0;
+        ReplayClock replay_clock(replaying ? args.replay_rate : 1,
+            start_batch > 0 ? dataset->getLastTimestamp(start_batch - 1) : dataset->getMinTimestamp());
+
+        for (int64_t batch_id = start_batch; batch_id < num_batches; ++batch_id)
         {
+            // Wait for the batch to arrive, or catch up on the batches that arrived while the graph was busy
+            // Batches are only coalesced up to the end of the epoch, so the algs run at the same points
+            int64_t first_batch_id = batch_id;
+            if (replaying) {
+                int64_t epoch_end = batch_id;
+                while (epoch_end + 1 < num_batches && !enable_algs_for_batch(epoch_end, num_batches, args.num_epochs)) {
+                    ++epoch_end;
+                }
+                batch_id = replay_clock.wait_for_batch(*dataset, batch_id, epoch_end);
+            }
+
             hooks.set_attr("batch", batch_id);
             hooks.set_attr("epoch", epoch);
 
             // Batch preprocessing (preprocess)
+            // When pipelined, this region only covers the time spent waiting for the producer
             hooks.region_begin("preprocess");
-            std::shared_ptr<DynoGraph::Batch> batch = get_preprocessed_batch(batch_id, *dataset, args.sort_mode);
+            PreparedBatch prepared;
+            if (batch_id != first_batch_id) {
+                prepared = prepare_coalesced_batch(first_batch_id, batch_id);
+            } else if (pipelined) {
+                prepared = producer->take();
+                total_producer_time += prepared.preprocess_time;
+                hooks.set_stat("producer_time", prepared.preprocess_time);
+            } else {
+                prepared = prepare_batch(batch_id);
+            }
             hooks.region_end();
+            std::shared_ptr<DynoGraph::Batch> batch = prepared.batch;
+            std::shared_ptr<DynoGraph::Batch> expired = prepared.expired;
 
-            int64_t threshold = dataset->getTimestampForWindow(batch_id);
+            int64_t threshold = prepared.threshold;
             graph.before_batch(*batch, threshold);
 
             // Edge deletion benchmark (deletions)
@@ -80,22 +288,61 @@ public:
                 logger << "Deleting edges older than " << threshold << "\n";
                 hooks.set_stat("num_vertices", graph.get_num_vertices());
                 hooks.set_stat("num_edges", graph.get_num_edges());
+                if (expired) { hooks.set_stat("num_expired_edges", static_cast<int64_t>(expired->size())); }
                 hooks.region_begin("deletions");
-                graph.delete_edges_older_than(threshold);
+                if (expired) {
+                    graph.delete_batch(*expired, threshold);
+                } else {
+                    graph.delete_edges_older_than(threshold);
+                }
                 hooks.region_end();
+                if (args.track_sources) {
+                    if (expired) {
+                        degree_tracker.delete_batch(graph, *expired);
+                    } else {
+                        degree_tracker.delete_edges_older_than();
+                    }
+                }
+            }
+
+            // Describe the batch, comparing against the edges that are still in the window
+            if (args.batch_stats)
+            {
+                if (!prepared.stats) { describe_batch(prepared); }
+                const BatchStats& stats = *prepared.stats;
+                hooks.set_stat("batch_max_vertex_id", stats.max_vertex_id);
+                hooks.set_stat("batch_num_vertices", stats.num_vertices);
+                hooks.set_stat("batch_num_edges", stats.num_edges);
+                hooks.set_stat("batch_degree_skew", stats.degree_skew);
+                hooks.set_stat("batch_timestamp_span", stats.timestamp_span);
+                hooks.set_stat("batch_existing_edge_fraction", stats.existing_edge_fraction);
             }
 
             // Edge insertion benchmark (insertions)
             logger << "Inserting batch " << batch_id << "\n";
+            if (replaying) {
+                hooks.set_stat("replay_lag_ms", replay_clock.get_lag_ms());
+                hooks.set_stat("coalesced_batches", batch_id - first_batch_id + 1);
+            }
             hooks.set_stat("num_vertices", graph.get_num_vertices());
             hooks.set_stat("num_edges", graph.get_num_edges());
             hooks.region_begin("insertions");
             graph.insert_batch(*batch);
+            // For streamed datasets, record how long it took for the batch to become visible after it arrived
+            double arrival_time = dataset->getArrivalTime(batch_id);
+            if (arrival_time >= 0) {
+                double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+                hooks.set_stat("ingest_latency_ms", (now - arrival_time) * 1e3);
+            }
             hooks.region_end();
+            if (args.track_sources) { degree_tracker.insert_batch(graph, *batch); }
 
             // Graph algorithm benchmarks
             if (enable_algs_for_batch(batch_id, num_batches, args.num_epochs))
             {
+                epoch_graph_sizes.push_back({graph.get_num_vertices(), graph.get_num_edges()});
+                // Source vertices are picked once per epoch, and reused for every alg and trial
+                epoch_sources.clear();
                 for (int64_t alg_trial = 0; alg_trial < args.num_alg_trials; ++alg_trial)
                 {
                     // When we do multiple trials, algs should start with the same data each time
@@ -106,11 +353,8 @@ public:
                     {
                         if (args.sources_path.empty()) {
                             // Pick source vertex(s)
-                            int64_t num_sources;
-                            if (alg_name == "bfs" || alg_name == "sssp") { num_sources = 64; }
-                            else if (alg_name == "bc") { num_sources = 128; }
-                            else { num_sources = 0; }
-                            sources = graph.get_high_degree_vertices(num_sources);
+                            int64_t num_sources = get_num_sources(alg_name);
+                            sources = get_high_degree_vertices(graph, num_sources, nullptr);
                             if (sources.size() == 1) {
                                 hooks.set_stat("source_vertex", sources[0]);
                             }
@@ -132,6 +376,126 @@ public:
             }
         }
         assert(epoch == args.num_epochs);
+        if (pipelined) {
+            logger << "Pipeline producer spent " << total_producer_time << " seconds preprocessing, "
+                   << "insertions stalled for " << producer->get_stall_time() << " seconds\n";
+            // Report the results in an empty region, so they land in the hooks output
+            hooks.set_stat("producer_time", total_producer_time);
+            hooks.set_stat("stall_time", producer->get_stall_time());
+            hooks.region_begin("pipeline");
+            hooks.region_end();
+        }
+        if (replaying) {
+            logger << "Replay missed " << replay_clock.get_num_missed_deadlines() << " deadlines, "
+                   << "with a maximum lag of " << replay_clock.get_max_lag_ms() << " ms. "
+                   << "Sustainable rate was " << replay_clock.get_sustainable_rate() << " timestamps per second\n";
+            // Report the results in an empty region, so they land in the hooks output
+            hooks.set_stat("replay_rate", args.replay_rate);
+            hooks.set_stat("missed_deadlines", replay_clock.get_num_missed_deadlines());
+            hooks.set_stat("max_lag_ms", replay_clock.get_max_lag_ms());
+            hooks.set_stat("sustainable_rate", replay_clock.get_sustainable_rate());
+            hooks.region_begin("replay");
+            hooks.region_end();
+        }
+        // Reset dataset for next trial
+        dataset->reset();
+        snapshot_builder.reset();
+        degree_tracker.reset();
+    }
+
+    template<typename graph_t>
+    void
+    run_concurrent()
+    {
+        // Initialize the graph data structure
+        graph_t graph(args, max_vertex_id);
+        if (!graph.supports_concurrent_reads()) {
+            logger << "This graph does not support running algs during insertions (--query-interval-ms)\n";
+            die();
+        }
+
+        // Algs run on their own thread at a fixed interval, while this thread inserts batches back to back
+        // Only this thread calls the hooks, so the query thread keeps its latencies in a histogram
+        QueryControl control;
+        LatencyHistogram query_latency("query");
+        std::future<int64_t> queries = std::async(std::launch::async, &Benchmark::run_queries, this,
+            std::ref(graph), std::ref(control), std::ref(query_latency));
+
+        int64_t num_batches = dataset->getNumBatches();
+        int64_t num_inserted_edges = 0;
+        double insertion_time = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t batch_id = 0; batch_id < num_batches; ++batch_id)
+        {
+            hooks.set_attr("batch", batch_id);
+
+            // Batch preprocessing (preprocess)
+            hooks.region_begin("preprocess");
+            PreparedBatch prepared = prepare_batch(batch_id);
+            hooks.region_end();
+            std::shared_ptr<DynoGraph::Batch> batch = prepared.batch;
+            std::shared_ptr<DynoGraph::Batch> expired = prepared.expired;
+
+            int64_t threshold = prepared.threshold;
+            graph.before_batch(*batch, threshold);
+
+            // Edge deletion benchmark (deletions)
+            if (args.window_size != 1.0)
+            {
+                logger << "Deleting edges older than " << threshold << "\n";
+                hooks.set_stat("num_vertices", graph.get_num_vertices());
+                hooks.set_stat("num_edges", graph.get_num_edges());
+                if (expired) { hooks.set_stat("num_expired_edges", static_cast<int64_t>(expired->size())); }
+                hooks.region_begin("deletions");
+                if (expired) {
+                    graph.delete_batch(*expired, threshold);
+                } else {
+                    graph.delete_edges_older_than(threshold);
+                }
+                hooks.region_end();
+            }
+
+            // Edge insertion benchmark (insertions)
+            logger << "Inserting batch " << batch_id << "\n";
+            hooks.set_stat("num_vertices", graph.get_num_vertices());
+            hooks.set_stat("num_edges", graph.get_num_edges());
+            hooks.region_begin("insertions");
+            auto insert_start = std::chrono::steady_clock::now();
+            graph.insert_batch(*batch);
+            insertion_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - insert_start).count();
+            hooks.region_end();
+            num_inserted_edges += batch->size();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        control.stop();
+        int64_t num_queries = queries.get();
+        // There are no epochs here, so only the final graph can be compared
+        epoch_graph_sizes.clear();
+        epoch_graph_sizes.push_back({graph.get_num_vertices(), graph.get_num_edges()});
+
+        double insertion_rate = insertion_time > 0 ? num_inserted_edges / insertion_time : 0;
+        logger << "Inserted " << num_inserted_edges << " edges in " << elapsed << " seconds "
+               << "(" << insertion_rate << " edges per second while inserting), "
+               << "and ran the algs " << num_queries << " times alongside\n";
+        if (query_latency.get_count() > 0) {
+            logger << "Query latency: median " << query_latency.get_percentile(0.5) / 1e6 << " ms, "
+                   << "p99 " << query_latency.get_percentile(0.99) / 1e6 << " ms, "
+                   << "max " << query_latency.get_max() / 1e6 << " ms\n";
+        }
+        // Report the results in an empty region, so they land in the hooks output
+        hooks.set_stat("query_interval_ms", args.query_interval_ms);
+        hooks.set_stat("query_threads", args.query_threads);
+        hooks.set_stat("num_inserted_edges", num_inserted_edges);
+        hooks.set_stat("insertion_rate", insertion_rate);
+        hooks.set_stat("num_queries", num_queries);
+        if (query_latency.get_count() > 0) {
+            hooks.set_stat("query_p50_ms", query_latency.get_percentile(0.5) / 1e6);
+            hooks.set_stat("query_p99_ms", query_latency.get_percentile(0.99) / 1e6);
+            hooks.set_stat("query_max_ms", query_latency.get_max() / 1e6);
+        }
+        hooks.region_begin("concurrent");
+        hooks.region_end();
+
         // Reset dataset for next trial
         dataset->reset();
     }
@@ -141,6 +505,7 @@ public:
     run_static()
     {
         DynamicGraph * graph;
+        epoch_graph_sizes.clear();
 
         // Step through one batch at a time
         // Epoch will be incremented as necessary
@@ -156,16 +521,22 @@ public:
                 logger << "Generating graph snapshot\n";
 
                 // This batch will be a cumulative, filtered snapshot of all the edges in previous batches
+                // The snapshot builder only has to merge in the batches since the last epoch
                 hooks.region_begin("preprocess");
-                std::shared_ptr<DynoGraph::Batch> batch = get_preprocessed_batch(batch_id, *dataset, args.sort_mode);
+                int64_t threshold = dataset->getTimestampForWindow(batch_id);
+                std::shared_ptr<DynoGraph::Batch> batch = snapshot_builder.get_snapshot(*dataset, batch_id, threshold);
+                batch = partition_batch(batch, max_vertex_id, args);
                 hooks.region_end();
 
                 logger << "Initializing graph for epoch " << epoch << "\n";
+                // Source vertices are picked once per epoch, and reused for every alg and trial
+                epoch_sources.clear();
 
                 // Initialize the graph data structure
                 hooks.region_begin("construct");
                 graph = new graph_t(args, max_vertex_id, *batch);
                 hooks.region_end();
+                epoch_graph_sizes.push_back({graph->get_num_vertices(), graph->get_num_edges()});
 
                 // Graph algorithm benchmarks
                 for (int64_t alg_trial = 0; alg_trial < args.num_alg_trials; ++alg_trial)
@@ -178,11 +549,8 @@ public:
                     {
                         if (args.sources_path.empty()) {
                             // Pick source vertex(s)
-                            int64_t num_sources;
-                            if (alg_name == "bfs" || alg_name == "sssp") { num_sources = 64; }
-                            else if (alg_name == "bc") { num_sources = 128; }
-                            else { num_sources = 0; }
-                            sources = graph->get_high_degree_vertices(num_sources);
+                            int64_t num_sources = get_num_sources(alg_name);
+                            sources = get_high_degree_vertices(*graph, num_sources, batch.get());
                             if (sources.size() == 1) {
                                 hooks.set_stat("source_vertex", sources[0]);
                             }
@@ -211,23 +579,167 @@ public:
         assert(epoch == args.num_epochs);
         // Reset dataset for next trial
         dataset->reset();
+        snapshot_builder.reset();
     }
 
     template<typename graph_t>
-    static void
-    run(int argc, char **argv)
+    void
+    run_trial(int64_t trial)
+    {
+        hooks.set_attr("trial", trial);
+        switch (args.sort_mode) {
+            case Args::SORT_MODE::SNAPSHOT:
+                run_static<graph_t>();
+                break;
+            case Args::SORT_MODE::UNSORTED:
+            case Args::SORT_MODE::PRESORT:
+            case Args::SORT_MODE::LOCALITY:
+            case Args::SORT_MODE::HYBRID:
+                if (args.query_interval_ms > 0) {
+                    run_concurrent<graph_t>();
+                } else {
+                    run_dynamic<graph_t>();
+                }
+                break;
+        }
+        // Write out latency distributions for the regions that were summarized this trial
+        hooks.write_summary();
+    }
+
+    template<typename graph_t>
+    void
+    run_trials()
     {
-        Args args = Args::parse(argc, argv);
-        Benchmark benchmark(args);
         for (int64_t trial = 0; trial < args.num_trials; trial++)
         {
-            Hooks::getInstance().set_attr("trial", trial);
-            if (args.sort_mode == Args::SORT_MODE::SNAPSHOT) {
-                benchmark.run_static<graph_t>();
-            } else if (args.sort_mode == Args::SORT_MODE::UNSORTED) {
-                benchmark.run_dynamic<graph_t>();
+            run_trial<graph_t>(trial);
+        }
+    }
+
+    // Runs one trial of an engine, tagging the results with its name, and checks it against the other engines
+    template<typename graph_t>
+    void
+    run_engine_trial(int64_t trial)
+    {
+        std::string engine = demangle(typeid(graph_t).name());
+        logger << "Running trial " << trial << " of " << engine << "\n";
+        hooks.set_attr("engine", engine);
+        run_trial<graph_t>(trial);
+        check_graph_sizes(trial, engine);
+    }
+
+    template<typename graph_t>
+    void
+    run_engine_trials()
+    {
+        for (int64_t trial = 0; trial < args.num_trials; trial++)
+        {
+            run_engine_trial<graph_t>(trial);
+        }
+    }
+
+    // Runs every trial of each engine, either one engine after another or alternating every trial
+    // Exits if an engine builds a graph of a different size than the first engine to run the same trial
+    template<typename... graph_types>
+    void
+    run_engines()
+    {
+        // Expanding the parameter pack in an initializer list runs the engines in the order they are listed
+        if (args.interleave_engines) {
+            for (int64_t trial = 0; trial < args.num_trials; trial++)
+            {
+                int in_order[] = { (run_engine_trial<graph_types>(trial), 0)... };
+                (void)in_order;
+            }
+        } else {
+            int in_order[] = { (run_engine_trials<graph_types>(), 0)... };
+            (void)in_order;
+        }
+    }
+
+    // Sets the number of OpenMP threads for the next round of trials in a thread sweep
+    void set_num_threads(int64_t num_threads);
+    // Reports the speedup and parallel efficiency of each region, relative to the first thread count in the sweep
+    // Takes the total time spent in each region at each thread count
+    void report_thread_scaling(const std::vector<std::map<std::string, double>>& region_times);
+
+    template<typename graph_t>
+    void
+    run_sweep()
+    {
+        if (args.thread_sweep.empty()) {
+            run_trials<graph_t>();
+            return;
+        }
+        // The dataset is only loaded once, then every trial is rerun at each thread count
+        std::vector<std::map<std::string, double>> region_times;
+        for (int64_t num_threads : args.thread_sweep)
+        {
+            set_num_threads(num_threads);
+            run_trials<graph_t>();
+            region_times.push_back(hooks.take_region_times());
+        }
+        report_thread_scaling(region_times);
+    }
+
+    template<typename graph_t>
+    static void
+    run_plan(int argc, char **argv)
+    {
+        // Parse every configuration up front, so a bad entry is caught before anything runs
+        std::vector<Args> configs = Args::parse_plan(argc, argv);
+        Logger& logger = Logger::get_instance();
+        std::shared_ptr<IDataset> dataset = create_dataset(configs[0]);
+        // Datasets that can be re-sliced are checked against every configuration before anything runs
+        if (dataset->reconfigure(configs[0])) {
+            std::ostringstream problems;
+            for (size_t i = 0; i < configs.size(); ++i) {
+                std::string problem = check_fits_dataset(configs[i], dataset->getNumEdges());
+                if (!problem.empty()) { problems << "Configuration " << i + 1 << ":\n" << problem; }
+            }
+            if (!problems.str().empty()) {
+                logger << "Invalid experiment plan:\n" << problems.str();
+                die();
             }
         }
+        for (size_t i = 0; i < configs.size(); ++i)
+        {
+            logger << "Running configuration " << i + 1 << " of " << configs.size() << "\n";
+            Hooks::getInstance().set_attr("config", static_cast<int64_t>(i));
+            // Reuse the edges that were already loaded, only re-slicing them into batches
+            if (i > 0 && !dataset->reconfigure(configs[i])) {
+                dataset = create_dataset(configs[i]);
+            }
+            Benchmark benchmark(configs[i], dataset);
+            benchmark.run_sweep<graph_t>();
+        }
+    }
+
+    // Replays the same batches against each engine, loading the dataset only once
+    template<typename... graph_types>
+    static void
+    run_all(int argc, char **argv)
+    {
+        Args args = Args::parse(argc, argv);
+        if (!args.experiment_plan.empty() || !args.thread_sweep.empty()) {
+            Logger::get_instance() << "--experiment-plan and --thread-sweep are not supported when comparing engines\n";
+            die();
+        }
+        Benchmark benchmark(args);
+        benchmark.run_engines<graph_types...>();
+    }
+
+    template<typename graph_t>
+    static void
+    run(int argc, char **argv)
+    {
+        Args args = Args::parse(argc, argv);
+        if (!args.experiment_plan.empty()) {
+            run_plan<graph_t>(argc, argv);
+            return;
+        }
+        Benchmark benchmark(args);
+        benchmark.run_sweep<graph_t>();
     }
 
 }; // end class Benchmark
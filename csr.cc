@@ -0,0 +1,190 @@
+#include "csr.h"
+#include "helpers.h"
+#include <algorithm>
+#include <vector>
+
+using namespace DynoGraph;
+
+namespace {
+
+// Replaces each element with the sum of all elements before it
+void
+exclusive_prefix_sum(pvector<int64_t>& a)
+{
+    int64_t n = static_cast<int64_t>(a.size());
+    int64_t num_chunks = get_num_chunks();
+    // Sum each chunk
+    pvector<int64_t> chunk_sums(num_chunks + 1);
+    chunk_sums[0] = 0;
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t sum = 0;
+        for (int64_t i = n * c / num_chunks; i < n * (c+1) / num_chunks; ++i) { sum += a[i]; }
+        chunk_sums[c+1] = sum;
+    }
+    for (int64_t c = 0; c < num_chunks; ++c) { chunk_sums[c+1] += chunk_sums[c]; }
+    // Scan each chunk, starting from the sum of the chunks before it
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t sum = chunk_sums[c];
+        for (int64_t i = n * c / num_chunks; i < n * (c+1) / num_chunks; ++i) {
+            int64_t x = a[i];
+            a[i] = sum;
+            sum += x;
+        }
+    }
+}
+
+struct Neighbor
+{
+    int64_t id;
+    int64_t weight;
+    int64_t timestamp;
+};
+
+// Sorts the neighbor list in [begin, end) by vertex ID, keeping the weights and timestamps lined up
+void
+sort_neighbors(pvector<int64_t>& neighbors, pvector<int64_t>& weights, pvector<int64_t>& timestamps,
+    int64_t begin, int64_t end, std::vector<Neighbor>& scratch)
+{
+    if (end - begin < 2) { return; }
+    scratch.resize(end - begin);
+    for (int64_t j = begin; j < end; ++j) {
+        scratch[j - begin] = {neighbors[j], weights[j], timestamps[j]};
+    }
+    std::sort(scratch.begin(), scratch.end(),
+        [](const Neighbor& a, const Neighbor& b) { return a.id < b.id; });
+    for (int64_t j = begin; j < end; ++j) {
+        neighbors[j] = scratch[j - begin].id;
+        weights[j] = scratch[j - begin].weight;
+        timestamps[j] = scratch[j - begin].timestamp;
+    }
+}
+
+} // end anonymous namespace
+
+CSR::CSR(const Batch& batch, int64_t max_vertex_id, bool transpose)
+: offsets(max_vertex_id + 2, 0)
+, neighbors(batch.size())
+, weights(batch.size())
+, timestamps(batch.size())
+{
+    // Batches that are already grouped by source can be copied into place, without atomics
+    if (!transpose) {
+        const GroupedBatch* grouped = dynamic_cast<const GroupedBatch*>(&batch);
+        if (grouped && grouped->num_sources() > 0) {
+            build_from_runs(*grouped);
+            return;
+        }
+        if (std::is_sorted(batch.begin(), batch.end(), by_src_dst)) {
+            build_from_sorted(batch);
+            return;
+        }
+    }
+    build_from_scatter(batch, transpose);
+}
+
+void
+CSR::build_from_sorted(const Batch& batch)
+{
+    const Edge* edges = batch.begin();
+    int64_t num_edges = static_cast<int64_t>(batch.size());
+
+    // Count the degree of each vertex from the length of its run
+    // Each thread handles whole runs, so the start of a run walks the rest of it
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t i = 0; i < num_edges; ++i) {
+        if (i > 0 && edges[i].src == edges[i-1].src) { continue; }
+        int64_t j = i + 1;
+        while (j < num_edges && edges[j].src == edges[i].src) { ++j; }
+        offsets[edges[i].src] = j - i;
+    }
+    exclusive_prefix_sum(offsets);
+
+    // Edges sorted by src and dst are already in the order of the neighbor lists
+    #pragma omp parallel for
+    for (int64_t i = 0; i < num_edges; ++i) {
+        neighbors[i] = edges[i].dst;
+        weights[i] = edges[i].weight;
+        timestamps[i] = edges[i].timestamp;
+    }
+}
+
+void
+CSR::build_from_runs(const GroupedBatch& batch)
+{
+    int64_t num_sources = batch.num_sources();
+    #pragma omp parallel for
+    for (int64_t i = 0; i < num_sources; ++i) {
+        offsets[batch.source(i)] = static_cast<int64_t>(batch.edges_from(i).size());
+    }
+    exclusive_prefix_sum(offsets);
+
+    // Copy each run into the neighbor list of its source
+    // Runs from the degree sorts are ordered by the degree of the destination, so those still need a sort
+    #pragma omp parallel
+    {
+        std::vector<Neighbor> scratch;
+        #pragma omp for schedule(dynamic, 64)
+        for (int64_t i = 0; i < num_sources; ++i) {
+            Batch run = batch.edges_from(i);
+            int64_t begin = offsets[batch.source(i)];
+            int64_t pos = begin;
+            for (const Edge& e : run) {
+                neighbors[pos] = e.dst;
+                weights[pos] = e.weight;
+                timestamps[pos] = e.timestamp;
+                ++pos;
+            }
+            if (!std::is_sorted(run.begin(), run.end(), by_src_dst)) {
+                sort_neighbors(neighbors, weights, timestamps, begin, pos, scratch);
+            }
+        }
+    }
+}
+
+void
+CSR::build_from_scatter(const Batch& batch, bool transpose)
+{
+    const Edge* edges = batch.begin();
+    int64_t num_edges = static_cast<int64_t>(batch.size());
+    int64_t nv = static_cast<int64_t>(offsets.size()) - 1;
+    auto key = [transpose](const Edge& e) { return transpose ? e.dst : e.src; };
+    auto value = [transpose](const Edge& e) { return transpose ? e.src : e.dst; };
+
+    // Count the degree of each vertex
+    #pragma omp parallel for
+    for (int64_t i = 0; i < num_edges; ++i) {
+        #pragma omp atomic
+        offsets[key(edges[i])] += 1;
+    }
+
+    // Convert degrees into offsets
+    exclusive_prefix_sum(offsets);
+
+    // Scatter the edges into place
+    // Each vertex has a cursor that starts at the beginning of its neighbor list
+    pvector<int64_t> cursors(nv);
+    #pragma omp parallel for
+    for (int64_t v = 0; v < nv; ++v) { cursors[v] = offsets[v]; }
+    #pragma omp parallel for
+    for (int64_t i = 0; i < num_edges; ++i) {
+        const Edge& e = edges[i];
+        int64_t pos;
+        #pragma omp atomic capture
+        pos = cursors[key(e)]++;
+        neighbors[pos] = value(e);
+        weights[pos] = e.weight;
+        timestamps[pos] = e.timestamp;
+    }
+
+    // The scatter runs in parallel, so sort each neighbor list to make the result deterministic
+    #pragma omp parallel
+    {
+        std::vector<Neighbor> scratch;
+        #pragma omp for schedule(dynamic, 1024)
+        for (int64_t v = 0; v < nv; ++v) {
+            sort_neighbors(neighbors, weights, timestamps, offsets[v], offsets[v+1], scratch);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "batch.h"
+#include "range.h"
+#include "pvector.h"
+#include <cinttypes>
+
+namespace DynoGraph {
+
+// Compressed sparse row (CSR) representation of the edges in a batch
+// The neighbors of vertex v are stored in [offsets[v], offsets[v+1]), sorted by vertex ID.
+// Engines can use this to build their graph in a bulk constructor.
+class CSR
+{
+protected:
+    pvector<int64_t> offsets;
+    pvector<int64_t> neighbors;
+    pvector<int64_t> weights;
+    pvector<int64_t> timestamps;
+public:
+    // Build from a batch of edges, which must not contain duplicates
+    // If transpose is true, build a CSC instead (the in-edges of each vertex)
+    // Batches that are sorted by src and dst, or indexed by source, are copied into place without atomics
+    CSR(const Batch& batch, int64_t max_vertex_id, bool transpose = false);
+
+    int64_t num_vertices() const { return static_cast<int64_t>(offsets.size()) - 1; }
+    int64_t num_edges() const { return static_cast<int64_t>(neighbors.size()); }
+    int64_t get_degree(int64_t v) const { return offsets[v+1] - offsets[v]; }
+    // Returns the neighbors of v, and the weight and timestamp of each edge
+    Range<int64_t> get_neighbors(int64_t v) const { return slice(neighbors, v); }
+    Range<int64_t> get_weights(int64_t v) const { return slice(weights, v); }
+    Range<int64_t> get_timestamps(int64_t v) const { return slice(timestamps, v); }
+    // Direct access to the arrays
+    const pvector<int64_t>& get_offsets() const { return offsets; }
+    const pvector<int64_t>& get_neighbors() const { return neighbors; }
+    const pvector<int64_t>& get_weights() const { return weights; }
+    const pvector<int64_t>& get_timestamps() const { return timestamps; }
+private:
+    // Fills in the arrays from a batch sorted by src and dst, which is already in CSR order
+    void build_from_sorted(const Batch& batch);
+    // Fills in the arrays from a batch with an index of the runs of each source
+    void build_from_runs(const GroupedBatch& batch);
+    // Fills in the arrays from a batch in any order, by counting degrees and scattering each edge into place
+    void build_from_scatter(const Batch& batch, bool transpose);
+    Range<int64_t> slice(const pvector<int64_t>& a, int64_t v) const {
+        return Range<int64_t>(a.begin() + offsets[v], a.begin() + offsets[v+1]);
+    }
+};
+
+} // end namespace DynoGraph
@@ -0,0 +1,84 @@
+#include "csr.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+
+using namespace DynoGraph;
+
+// Make sure each vertex gets the right neighbors, in order
+TEST(CSRTest, BuildFromBatch) {
+    std::vector<Edge> edges = {
+        {3, 1, 7, 100},
+        {1, 2, 1, 200},
+        {3, 0, 2, 300},
+        {1, 3, 4, 400},
+        {0, 3, 5, 500},
+    };
+    Batch batch(edges);
+    CSR csr(batch, 4);
+    ASSERT_EQ(csr.num_vertices(), 5);
+    ASSERT_EQ(csr.num_edges(), 5);
+    EXPECT_EQ(csr.get_degree(0), 1);
+    EXPECT_EQ(csr.get_degree(1), 2);
+    EXPECT_EQ(csr.get_degree(2), 0);
+    EXPECT_EQ(csr.get_degree(3), 2);
+    EXPECT_EQ(csr.get_degree(4), 0);
+
+    Range<int64_t> neighbors = csr.get_neighbors(3);
+    EXPECT_EQ(neighbors[0], 0);
+    EXPECT_EQ(neighbors[1], 1);
+    EXPECT_EQ(csr.get_weights(3)[0], 2);
+    EXPECT_EQ(csr.get_timestamps(3)[1], 100);
+}
+
+// Make sure the transpose holds the in-edges of each vertex
+TEST(CSRTest, BuildTranspose) {
+    std::vector<Edge> edges = {
+        {3, 1, 7, 100},
+        {1, 2, 1, 200},
+        {3, 0, 2, 300},
+        {1, 3, 4, 400},
+        {0, 3, 5, 500},
+    };
+    Batch batch(edges);
+    CSR csc(batch, 3, true);
+    ASSERT_EQ(csc.num_vertices(), 4);
+    EXPECT_EQ(csc.get_degree(0), 1);
+    EXPECT_EQ(csc.get_degree(3), 2);
+    Range<int64_t> in_neighbors = csc.get_neighbors(3);
+    EXPECT_EQ(in_neighbors[0], 0);
+    EXPECT_EQ(in_neighbors[1], 1);
+    EXPECT_EQ(csc.get_weights(3)[0], 5);
+}
+
+// Batches that are sorted or indexed by source skip the scatter, but should give the same CSR
+TEST(CSRTest, GroupedInputMatchesScatter) {
+    int64_t max_vertex_id = 200;
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int64_t> vertex(0, max_vertex_id);
+    ConcreteBatch sorted(2000);
+    for (int64_t i = 0; i < 2000; ++i) {
+        sorted[i] = {vertex(rng), vertex(rng), i % 13, i};
+    }
+    sorted.dedup();
+
+    ConcreteBatch shuffled(static_cast<const Batch&>(sorted));
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    ASSERT_FALSE(std::is_sorted(shuffled.begin(), shuffled.end(), by_src_dst));
+    GroupedBatch indexed(sorted);
+    indexed.index_sources();
+    GroupedBatch degree_ordered(sorted);
+    degree_ordered.sort_by_out_degree();
+    degree_ordered.index_sources();
+
+    CSR expected(shuffled, max_vertex_id);
+    for (const Batch* batch : std::vector<const Batch*>{&sorted, &indexed, &degree_ordered}) {
+        CSR actual(*batch, max_vertex_id);
+        ASSERT_EQ(actual.num_vertices(), expected.num_vertices());
+        ASSERT_EQ(actual.num_edges(), expected.num_edges());
+        EXPECT_TRUE(std::equal(expected.get_offsets().begin(), expected.get_offsets().end(), actual.get_offsets().begin()));
+        EXPECT_TRUE(std::equal(expected.get_neighbors().begin(), expected.get_neighbors().end(), actual.get_neighbors().begin()));
+        EXPECT_TRUE(std::equal(expected.get_weights().begin(), expected.get_weights().end(), actual.get_weights().begin()));
+        EXPECT_TRUE(std::equal(expected.get_timestamps().begin(), expected.get_timestamps().end(), actual.get_timestamps().begin()));
+    }
+}
@@ -0,0 +1,206 @@
+#include "degree_tracker.h"
+#include "dynamic_graph.h"
+#include <algorithm>
+
+using namespace DynoGraph;
+
+namespace {
+
+// Adds the vertex to a min-heap of the top n vertices, evicting the lowest if it is full
+void
+keep_top(std::vector<vertex_degree>& heap, const vertex_degree& v, size_t n)
+{
+    auto greater = [](const vertex_degree& a, const vertex_degree& b) { return b < a; };
+    if (heap.size() < n) {
+        heap.push_back(v);
+        std::push_heap(heap.begin(), heap.end(), greater);
+    } else if (heap.front() < v) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        heap.back() = v;
+        std::push_heap(heap.begin(), heap.end(), greater);
+    }
+}
+
+} // end anonymous namespace
+
+std::vector<int64_t>
+DynoGraph::find_high_degree_vertices(const Batch& batch, int64_t n)
+{
+    std::vector<vertex_degree> top;
+    if (n <= 0) { return std::vector<int64_t>(); }
+    const Edge* edges = batch.begin();
+    int64_t num_edges = static_cast<int64_t>(batch.size());
+
+    // Each thread keeps the top n of the sources whose runs start in its share of the batch
+    #pragma omp parallel
+    {
+        std::vector<vertex_degree> local;
+        local.reserve(n);
+        #pragma omp for schedule(static) nowait
+        for (int64_t i = 0; i < num_edges; ++i) {
+            if (i > 0 && edges[i].src == edges[i-1].src) { continue; }
+            // Repeated copies of an edge sit next to each other, count them once
+            int64_t degree = 1;
+            for (int64_t j = i + 1; j < num_edges && edges[j].src == edges[i].src; ++j) {
+                if (edges[j].dst != edges[j-1].dst) { ++degree; }
+            }
+            keep_top(local, vertex_degree(edges[i].src, degree), n);
+        }
+        #pragma omp critical
+        for (const vertex_degree& v : local) { keep_top(top, v, n); }
+    }
+
+    std::sort(top.begin(), top.end());
+    std::vector<int64_t> vertices(top.size());
+    std::transform(top.begin(), top.end(), vertices.begin(),
+        [](const vertex_degree& v) { return v.vertex_id; });
+    return vertices;
+}
+
+DegreeTracker::DegreeTracker() : stale(false) {}
+
+bool
+DegreeTracker::higher(int64_t a, int64_t b) const
+{
+    return vertex_degree(b, degrees[b]) < vertex_degree(a, degrees[a]);
+}
+
+void
+DegreeTracker::swap_heap(int64_t a, int64_t b)
+{
+    std::swap(heap[a], heap[b]);
+    heap_index[heap[a]] = a;
+    heap_index[heap[b]] = b;
+}
+
+void
+DegreeTracker::sift_up(int64_t pos)
+{
+    while (pos > 0) {
+        int64_t parent = (pos - 1) / 2;
+        if (!higher(heap[pos], heap[parent])) { break; }
+        swap_heap(pos, parent);
+        pos = parent;
+    }
+}
+
+void
+DegreeTracker::sift_down(int64_t pos)
+{
+    int64_t size = static_cast<int64_t>(heap.size());
+    while (true) {
+        int64_t top = pos;
+        for (int64_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < size; ++child) {
+            if (higher(heap[child], heap[top])) { top = child; }
+        }
+        if (top == pos) { break; }
+        swap_heap(pos, top);
+        pos = top;
+    }
+}
+
+void
+DegreeTracker::refresh(const DynamicGraph& graph, int64_t vertex_id)
+{
+    if (vertex_id >= static_cast<int64_t>(degrees.size())) {
+        degrees.resize(vertex_id + 1, 0);
+        heap_index.resize(vertex_id + 1, -1);
+    }
+    int64_t degree = graph.get_out_degree(vertex_id);
+    int64_t pos = heap_index[vertex_id];
+    if (pos < 0) {
+        // Vertices with no outgoing edges are left out of the heap
+        if (degree == 0) { return; }
+        degrees[vertex_id] = degree;
+        heap.push_back(vertex_id);
+        heap_index[vertex_id] = heap.size() - 1;
+        sift_up(heap.size() - 1);
+    } else if (degree == 0) {
+        // Move the last vertex into the hole, then let it settle in either direction
+        degrees[vertex_id] = 0;
+        int64_t last = heap.size() - 1;
+        swap_heap(pos, last);
+        heap.pop_back();
+        heap_index[vertex_id] = -1;
+        if (pos < last) {
+            int64_t moved = heap[pos];
+            sift_up(pos);
+            sift_down(heap_index[moved]);
+        }
+    } else {
+        int64_t old_degree = degrees[vertex_id];
+        degrees[vertex_id] = degree;
+        if (degree > old_degree) { sift_up(pos); } else { sift_down(pos); }
+    }
+}
+
+void
+DegreeTracker::refresh(const DynamicGraph& graph, const Batch& batch, bool both_endpoints)
+{
+    const Edge* prev = nullptr;
+    for (const Edge& e : batch) {
+        // Sorted batches keep the edges of each source together, so most lookups are skipped
+        if (!prev || prev->src != e.src) { refresh(graph, e.src); }
+        if (both_endpoints) { refresh(graph, e.dst); }
+        prev = &e;
+    }
+}
+
+void
+DegreeTracker::insert_batch(const DynamicGraph& graph, const Batch& batch)
+{
+    // Symmetrized batches already list both directions of each edge
+    refresh(graph, batch, false);
+}
+
+void
+DegreeTracker::delete_batch(const DynamicGraph& graph, const Batch& batch)
+{
+    // Lists of expired edges may only hold one direction of an undirected edge
+    refresh(graph, batch, true);
+}
+
+void
+DegreeTracker::delete_edges_older_than()
+{
+    stale = true;
+}
+
+std::vector<int64_t>
+DegreeTracker::get_high_degree_vertices(const DynamicGraph& graph, int64_t n)
+{
+    // Deletions only lower degrees, so only the vertices already in the heap need to be read again
+    if (stale) {
+        std::vector<int64_t> tracked(heap);
+        for (int64_t vertex_id : tracked) { refresh(graph, vertex_id); }
+        stale = false;
+    }
+
+    // Walk the top of the heap in order, without disturbing it
+    std::vector<int64_t> vertices;
+    auto lower = [&](int64_t a, int64_t b) { return higher(heap[b], heap[a]); };
+    std::vector<int64_t> frontier;
+    if (!heap.empty()) { frontier.push_back(0); }
+    while (!frontier.empty() && static_cast<int64_t>(vertices.size()) < n) {
+        std::pop_heap(frontier.begin(), frontier.end(), lower);
+        int64_t pos = frontier.back();
+        frontier.pop_back();
+        vertices.push_back(heap[pos]);
+        for (int64_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < static_cast<int64_t>(heap.size()); ++child) {
+            frontier.push_back(child);
+            std::push_heap(frontier.begin(), frontier.end(), lower);
+        }
+    }
+    // Same order as DynamicGraph::get_high_degree_vertices, with the highest degree last
+    std::reverse(vertices.begin(), vertices.end());
+    return vertices;
+}
+
+void
+DegreeTracker::reset()
+{
+    degrees.clear();
+    heap.clear();
+    heap_index.clear();
+    stale = false;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "batch.h"
+#include "dynamic_graph.h"
+#include <cinttypes>
+#include <vector>
+
+namespace DynoGraph {
+
+// Returns the n vertices with the highest out-degree in the batch, in the same order as
+// DynamicGraph::get_high_degree_vertices (increasing degree, ties going to the lower vertex ID)
+// The edges of each source must be contiguous, with any duplicates next to each other, as in a
+// sorted batch or snapshot
+std::vector<int64_t>
+find_high_degree_vertices(const Batch& batch, int64_t n);
+
+// Tracks the out-degree of every vertex in the graph, so source vertices can be picked without
+// asking the graph to sort all of its vertices by degree
+// After each batch, only the vertices it touched have their degree read back from the graph,
+// and a heap keeps them ordered, so picking sources costs O(n log n) regardless of the graph size
+class DegreeTracker
+{
+private:
+    // Out-degree of each vertex, as of the last time it was touched
+    std::vector<int64_t> degrees;
+    // Max-heap of the vertices with outgoing edges, in the order of vertex_degree
+    std::vector<int64_t> heap;
+    // Position of each vertex in the heap, or -1 if it has no outgoing edges
+    std::vector<int64_t> heap_index;
+    // Set when edges were deleted without a list of them, so every degree must be read again
+    bool stale;
+    // Returns true if vertex a belongs above vertex b in the heap
+    bool higher(int64_t a, int64_t b) const;
+    void sift_up(int64_t pos);
+    void sift_down(int64_t pos);
+    void swap_heap(int64_t a, int64_t b);
+    // Reads the degree of the vertex back from the graph, and moves it to its place in the heap
+    void refresh(const DynamicGraph& graph, int64_t vertex_id);
+    // Reads the degree of every source in the batch, or every endpoint if both might have changed
+    void refresh(const DynamicGraph& graph, const Batch& batch, bool both_endpoints);
+public:
+    DegreeTracker();
+    // Records the edges that were just inserted into the graph
+    void insert_batch(const DynamicGraph& graph, const Batch& batch);
+    // Records the edges that were just deleted from the graph
+    void delete_batch(const DynamicGraph& graph, const Batch& batch);
+    // Records that the graph deleted edges without listing them
+    // Every tracked degree is read again before sources are picked next
+    void delete_edges_older_than();
+    // Returns the n vertices with the highest out-degree in the graph
+    std::vector<int64_t> get_high_degree_vertices(const DynamicGraph& graph, int64_t n);
+    // Forget every degree and start over with an empty graph
+    void reset();
+};
+
+} // end namespace DynoGraph
@@ -0,0 +1,102 @@
+#include "degree_tracker.h"
+#include "reference_impl.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DynoGraph;
+
+// The reference graph doesn't look at its args, but they shouldn't be left uninitialized
+static Args
+graph_args()
+{
+    Args args = Args();
+    args.num_epochs = 1;
+    args.input_path = "dummy";
+    args.batch_size = 20000;
+    args.sort_mode = Args::SORT_MODE::UNSORTED;
+    args.window_size = 1.0;
+    args.num_trials = 1;
+    return args;
+}
+
+// The top vertices should come back in increasing order of degree, with ties going to the lower vertex ID
+TEST(DegreeTrackerTest, FindHighDegreeVertices)
+{
+    std::vector<Edge> edges = {
+        {1, 2, 0, 0},
+        {1, 3, 0, 0},
+        {2, 1, 0, 0},
+        {2, 3, 0, 0},
+        {2, 4, 0, 0},
+        {3, 1, 0, 0},
+        {4, 1, 0, 0},
+        {4, 2, 0, 0},
+    };
+    Batch batch(edges.begin(), edges.end());
+    EXPECT_EQ(find_high_degree_vertices(batch, 0), std::vector<int64_t>());
+    EXPECT_EQ(find_high_degree_vertices(batch, 1), std::vector<int64_t>({2}));
+    EXPECT_EQ(find_high_degree_vertices(batch, 2), std::vector<int64_t>({1, 2}));
+    EXPECT_EQ(find_high_degree_vertices(batch, 3), std::vector<int64_t>({4, 1, 2}));
+    // Asking for more vertices than there are sources returns every source
+    EXPECT_EQ(find_high_degree_vertices(batch, 10), std::vector<int64_t>({3, 4, 1, 2}));
+}
+
+// Should pick the same vertices as the reference implementation, which sorts every vertex
+TEST(DegreeTrackerTest, MatchesReferenceImpl)
+{
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<int64_t> vertex(1, 1000);
+    std::vector<Edge> edges(20000);
+    for (Edge& e : edges) { e = {vertex(rng), vertex(rng), 1, 0}; }
+
+    reference_impl graph(graph_args(), 1000);
+    graph.insert_batch(Batch(edges.begin(), edges.end()));
+
+    GroupedBatch grouped(Batch(edges.begin(), edges.end()));
+    grouped.dedup();
+    for (int64_t n : {1, 64, 128}) {
+        EXPECT_EQ(find_high_degree_vertices(grouped, n), graph.get_high_degree_vertices(n));
+    }
+}
+
+// Should keep up with the graph as edges are inserted and deleted, whether or not it is told which ones
+TEST(DegreeTrackerTest, FollowsInsertionsAndDeletions)
+{
+    std::mt19937_64 rng(2);
+    std::uniform_int_distribution<int64_t> vertex(1, 300);
+    reference_impl graph(graph_args(), 300);
+    DegreeTracker tracker;
+
+    for (int64_t timestamp = 1; timestamp <= 40; ++timestamp)
+    {
+        // Drop everything older than the last ten batches
+        int64_t threshold = timestamp - 10;
+        if (timestamp % 3 == 0) {
+            graph.delete_edges_older_than(threshold);
+            tracker.delete_edges_older_than();
+        } else {
+            // Delete a random sample, which includes edges that are too new or were never inserted
+            std::vector<Edge> deleted(200);
+            for (Edge& e : deleted) { e = {vertex(rng), vertex(rng), 1, 0}; }
+            Batch deleted_batch(deleted.begin(), deleted.end());
+            graph.delete_batch(deleted_batch, threshold);
+            tracker.delete_batch(graph, deleted_batch);
+        }
+
+        std::vector<Edge> inserted(500);
+        for (Edge& e : inserted) { e = {vertex(rng), vertex(rng), 1, timestamp}; }
+        Batch inserted_batch(inserted.begin(), inserted.end());
+        graph.insert_batch(inserted_batch);
+        tracker.insert_batch(graph, inserted_batch);
+
+        for (int64_t n : {1, 16, 64}) {
+            ASSERT_EQ(tracker.get_high_degree_vertices(graph, n), graph.get_high_degree_vertices(n));
+        }
+    }
+
+    // After a reset, the tracker starts over with an empty graph
+    tracker.reset();
+    EXPECT_EQ(tracker.get_high_degree_vertices(graph, 16), std::vector<int64_t>());
+}
@@ -14,6 +14,7 @@ public:
     // Initialize an empty graph - you must provide a constructor with this signature
     DynamicGraph(Args args, int64_t max_vertex_id) : args(args) {}
     // Initialize a graph from an edge list - you must provide a constructor with this signature
+    // DynoGraph::CSR (csr.h) can build the adjacency arrays from the batch in parallel
     DynamicGraph(Args args, int64_t max_vertex_id, const Batch& batch) : args(args) {}
     virtual ~DynamicGraph() {}
     // Return list of supported algs - your class must implement this method
@@ -22,8 +23,19 @@ public:
     virtual void before_batch(const Batch& batch, int64_t threshold) = 0;
     // Delete edges in the graph with a timestamp older than <threshold>
     virtual void delete_edges_older_than(int64_t threshold) = 0;
+    // Delete the edges in <batch> if their timestamp in the graph is older than <threshold>
+    // The batch holds every edge that fell out of the window since the last deletion, so
+    // engines can override this to avoid scanning the whole graph.
+    // Edges that were updated since then will have a newer timestamp, and must be kept.
+    virtual void delete_batch(const Batch& batch, int64_t threshold) { delete_edges_older_than(threshold); }
     // Insert the batch of edges into the graph
+    // In presort, locality, hybrid and snapshot modes, the batch is a GroupedBatch, which indexes the edges of each source vertex
+    // If batch.is_directed() is false, the batch already holds both directions of every edge
+    // With --numa-nodes, the batch is a PartitionedBatch, so each socket can insert the edges of the vertices it owns
     virtual void insert_batch(const Batch& batch) = 0;
+    // Return true if update_alg and the getters can run on one thread while another thread inserts and deletes
+    // Required for --query-interval-ms, which runs algorithms alongside the insertions
+    virtual bool supports_concurrent_reads() const { return false; }
     // Run the specified algorithm
     virtual void update_alg(
             // Name of algorithm to run
@@ -146,6 +146,27 @@ TYPED_TEST_P(ImplTest, DeleteOlderThan)
     EXPECT_EQ(this->impl.get_out_degree(1), 0);
 }
 
+// Make sure the graph can delete a list of expired edges
+TYPED_TEST_P(ImplTest, DeleteBatch)
+{
+    // Create several edges with distinct timestamps
+    std::vector<Edge> edges = {
+        {1, 3, 0, 100},
+        {1, 4, 0, 200},
+        {1, 5, 0, 300},
+        {1, 4, 0, 400},
+    };
+    Batch batch(edges.begin(), edges.end());
+    this->impl.insert_batch(batch);
+    EXPECT_EQ(this->impl.get_num_edges(), 3);
+
+    // Should delete 1->3, but not 1->4, since it was updated at time 400
+    Batch expired(edges.begin(), edges.begin() + 2);
+    this->impl.delete_batch(expired, 250);
+    EXPECT_EQ(this->impl.get_num_edges(), 2);
+    EXPECT_EQ(this->impl.get_out_degree(1), 2);
+}
+
 // Make sure timestamps are updated on insert
 TYPED_TEST_P(ImplTest, TimestampUpdate)
 {
@@ -220,6 +241,7 @@ REGISTER_TYPED_TEST_CASE_P( ImplTest
     ,BidirectionalEdgeInsert
     ,GetOutDegree
     ,DeleteOlderThan
+    ,DeleteBatch
     ,TimestampUpdate
     ,PickSourceVertex
 );
@@ -6,8 +6,15 @@
 #include "benchmark.h"
 #include <gtest/gtest.h>
 #include "pvector.h"
+#include <latency_histogram.h>
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <future>
+#include <map>
+#include <mutex>
 #include <iostream>
+#include <thread>
 
 using namespace DynoGraph;
 
@@ -35,6 +42,150 @@ TEST(DynoGraphUtilTests, LoadSources) {
     remove(temp_filename.c_str());
 }
 
+// Make sure each configuration in an experiment plan starts from the command line
+TEST(DynoGraphUtilTests, ParseExperimentPlan) {
+    std::string temp_filename = "test_plan.json";
+    std::ofstream temp_file(temp_filename);
+    temp_file << "[{\"batch-size\": 1000, \"alg-names\": [\"bfs\", \"cc\"]},"
+              << " {\"window-size\": 0.5, \"sort-mode\": \"hybrid\", \"sort-once\": true}]";
+    temp_file.close();
+    std::vector<std::string> options = {"dynograph", "--num-epochs", "2", "--input-path", "data/worldcup-10K.graph.bin",
+        "--batch-size", "500", "--experiment-plan", temp_filename};
+    std::vector<char*> argv;
+    for (std::string &o : options) { argv.push_back(&o[0]); }
+    argv.push_back(nullptr);
+
+    std::vector<Args> configs = Args::parse_plan(static_cast<int>(options.size()), argv.data());
+    ASSERT_EQ(configs.size(), 2);
+    EXPECT_EQ(configs[0].batch_size, 1000);
+    EXPECT_EQ(configs[0].alg_names, std::vector<std::string>({"bfs", "cc"}));
+    EXPECT_EQ(configs[0].window_size, 1.0);
+    EXPECT_EQ(configs[1].batch_size, 500);
+    EXPECT_EQ(configs[1].window_size, 0.5);
+    EXPECT_EQ(configs[1].sort_mode, Args::SORT_MODE::HYBRID);
+    EXPECT_TRUE(configs[1].sort_once);
+    for (const Args &args : configs) {
+        EXPECT_EQ(args.num_epochs, 2);
+        EXPECT_EQ(args.input_path, "data/worldcup-10K.graph.bin");
+    }
+    remove(temp_filename.c_str());
+}
+
+// A flag set to false in the plan should turn off the same flag from the command line, even abbreviated
+TEST(DynoGraphUtilTests, ParseExperimentPlanFalseFlags) {
+    std::string temp_filename = "test_plan_flags.json";
+    std::ofstream temp_file(temp_filename);
+    temp_file << "[{\"batch-stats\": false},"
+              << " {\"sort-once\": false, \"batch-stats\": true},"
+              << " {\"num-trials\": 2}]";
+    temp_file.close();
+    std::vector<std::string> options = {"dynograph", "--num-epochs", "2", "--input-path", "data/worldcup-10K.graph.bin",
+        "--batch-size", "500", "--batch-stats", "--sort-o", "--experiment-plan", temp_filename};
+    std::vector<char*> argv;
+    for (std::string &o : options) { argv.push_back(&o[0]); }
+    argv.push_back(nullptr);
+
+    std::vector<Args> configs = Args::parse_plan(static_cast<int>(options.size()), argv.data());
+    ASSERT_EQ(configs.size(), 3);
+    EXPECT_FALSE(configs[0].batch_stats);
+    EXPECT_TRUE(configs[0].sort_once);
+    EXPECT_TRUE(configs[1].batch_stats);
+    EXPECT_FALSE(configs[1].sort_once);
+    EXPECT_TRUE(configs[2].batch_stats);
+    EXPECT_TRUE(configs[2].sort_once);
+    for (const Args &args : configs) {
+        EXPECT_EQ(args.num_epochs, 2);
+        EXPECT_EQ(args.batch_size, 500);
+    }
+    remove(temp_filename.c_str());
+}
+
+// Each configuration in a plan should be checked against the dataset before anything runs
+TEST(DynoGraphUtilTests, CheckFitsDataset) {
+    Args args = Args();
+    args.num_epochs = 4;
+    args.batch_size = 100;
+    args.start_batch = 9;
+    EXPECT_EQ(check_fits_dataset(args, 1000), "");
+    // Leftover edges don't make up another batch
+    EXPECT_NE(check_fits_dataset(args, 999), "");
+    args.start_batch = 0;
+    args.num_epochs = 10;
+    EXPECT_EQ(check_fits_dataset(args, 1000), "");
+    args.num_epochs = 11;
+    EXPECT_NE(check_fits_dataset(args, 1000), "");
+    args.num_epochs = 1;
+    args.batch_size = 1001;
+    EXPECT_NE(check_fits_dataset(args, 1000), "");
+}
+
+// Speedup and efficiency should be relative to the first thread count, from the total time in each region
+TEST(DynoGraphUtilTests, ComputeThreadScaling) {
+    std::vector<int64_t> thread_sweep = {2, 4, 8};
+    std::vector<std::map<std::string, double>> region_times = {
+        {{"insertions", 800}, {"pagerank", 600}},
+        {{"insertions", 400}, {"pagerank", 400}},
+        // A region can be missing or take no time at some thread counts
+        {{"insertions", 0}},
+    };
+    std::vector<ThreadScaling> results = compute_thread_scaling(thread_sweep, region_times, 2);
+    ASSERT_EQ(results.size(), 4);
+    // Regions come out in name order, then by thread count
+    EXPECT_EQ(results[0].region_name, "insertions");
+    EXPECT_EQ(results[0].num_threads, 2);
+    EXPECT_DOUBLE_EQ(results[0].region_time_ms, 400);
+    EXPECT_DOUBLE_EQ(results[0].speedup, 1);
+    EXPECT_DOUBLE_EQ(results[0].efficiency, 1);
+    EXPECT_EQ(results[1].region_name, "insertions");
+    EXPECT_EQ(results[1].num_threads, 4);
+    EXPECT_DOUBLE_EQ(results[1].region_time_ms, 200);
+    EXPECT_DOUBLE_EQ(results[1].speedup, 2);
+    EXPECT_DOUBLE_EQ(results[1].efficiency, 1);
+    EXPECT_EQ(results[2].region_name, "pagerank");
+    EXPECT_EQ(results[2].num_threads, 2);
+    EXPECT_DOUBLE_EQ(results[2].speedup, 1);
+    EXPECT_EQ(results[3].region_name, "pagerank");
+    EXPECT_EQ(results[3].num_threads, 4);
+    EXPECT_DOUBLE_EQ(results[3].region_time_ms, 200);
+    EXPECT_DOUBLE_EQ(results[3].speedup, 1.5);
+    EXPECT_DOUBLE_EQ(results[3].efficiency, 0.75);
+
+    EXPECT_TRUE(compute_thread_scaling({}, {}, 1).empty());
+}
+
+// Re-slicing a loaded dataset should give the same batches as loading it again
+TEST(DynoGraphUtilTests, ReconfigureMatchesFreshLoad) {
+    for (std::string input_path : { "data/worldcup-10K.graph.bin", "0.55-0.20-0.10-0.15-44500-8K.rmat" }) {
+        Args args = Args();
+        args.num_epochs = 3;
+        args.input_path = input_path;
+        args.batch_size = 500;
+        args.sort_mode = Args::SORT_MODE::UNSORTED;
+        args.window_size = 1.0;
+        args.num_trials = 1;
+        args.numa_nodes = 1;
+        args.query_threads = 1;
+        std::shared_ptr<IDataset> dataset = create_dataset(args);
+        args.batch_size = 1000;
+        args.window_size = 0.5;
+        args.num_epochs = 2;
+        ASSERT_TRUE(dataset->reconfigure(args));
+        std::shared_ptr<IDataset> fresh = create_dataset(args);
+
+        ASSERT_EQ(dataset->getNumBatches(), fresh->getNumBatches());
+        for (int64_t i = 0; i < fresh->getNumBatches(); ++i) {
+            EXPECT_EQ(dataset->getTimestampForWindow(i), fresh->getTimestampForWindow(i));
+            std::shared_ptr<Batch> actual = dataset->getBatch(i);
+            std::shared_ptr<Batch> expected = fresh->getBatch(i);
+            ASSERT_EQ(actual->size(), expected->size());
+            EXPECT_TRUE(std::equal(actual->begin(), actual->end(), expected->begin()));
+        }
+        // Changing the input path means the dataset has to be loaded again
+        args.input_path = "data/ring-of-cliques.graph.el";
+        EXPECT_FALSE(dataset->reconfigure(args));
+    }
+}
+
 class DatasetTest: public ::testing::TestWithParam<Args> {
 public:
     static std::vector<Args> all_args;
@@ -43,6 +194,24 @@ public:
         Args args;
         args.input_path = "data/worldcup-10K.graph.bin";
         args.num_trials = 1;
+        args.num_alg_trials = 1;
+        args.batch_stats = false;
+        args.undirected = false;
+        args.numa_nodes = 1;
+        args.numa_mapping = Args::NUMA_MAPPING::BLOCK;
+        args.aggregation = {EdgeAggregation::WEIGHT::SUM, EdgeAggregation::TIME::LAST};
+        args.aggregate = false;
+        args.pipeline_threads = 0;
+        args.sort_once = false;
+        args.track_sources = false;
+        args.replay_rate = 0;
+        args.query_interval_ms = 0;
+        args.query_threads = 1;
+        args.thread_sweep = {};
+        args.experiment_plan = "";
+        args.interleave_engines = false;
+        args.start_batch = 0;
+        args.snapshot_source_order = false;
         args.sort_mode = Args::SORT_MODE::UNSORTED;
         args.alg_names = {};
 
@@ -87,6 +256,16 @@ TEST_P(DatasetTest, LoadDatasetCorrectly) {
     }
 }
 
+// Partitioning needs at least one NUMA node
+TEST(DynoGraphUtilTests, ArgValidationNumaNodes) {
+    Args args = DatasetTest::all_args[0];
+    EXPECT_EQ(args.validate(), "");
+    for (int64_t numa_nodes : {0, -1}) {
+        args.numa_nodes = numa_nodes;
+        EXPECT_NE(args.validate(), "");
+    }
+}
+
 // TODO this isn't a dataset test anymore, now that enable_algs_for_batch is a free function
 TEST_P(DatasetTest, DontSkipAnyEpochs) {
     const Args &args = GetParam();
@@ -121,6 +300,24 @@ public:
         args.input_path = "data/worldcup-10K.graph.bin";
         args.num_epochs = 1;
         args.num_trials = 1;
+        args.num_alg_trials = 1;
+        args.batch_stats = false;
+        args.undirected = false;
+        args.numa_nodes = 1;
+        args.numa_mapping = Args::NUMA_MAPPING::BLOCK;
+        args.aggregation = {EdgeAggregation::WEIGHT::SUM, EdgeAggregation::TIME::LAST};
+        args.aggregate = false;
+        args.pipeline_threads = 0;
+        args.sort_once = false;
+        args.track_sources = false;
+        args.replay_rate = 0;
+        args.query_interval_ms = 0;
+        args.query_threads = 1;
+        args.thread_sweep = {};
+        args.experiment_plan = "";
+        args.interleave_engines = false;
+        args.start_batch = 0;
+        args.snapshot_source_order = false;
         args.alg_names = {};
 
         for (int64_t batch_size : { 100, 500, 5000 }) {
@@ -155,6 +352,16 @@ TEST_P(SortModeTest, SortModeDoesntAffectEdgeCount)
     args.sort_mode = SORT_MODE::SNAPSHOT;
     reference_impl snapshot_graph(args, max_vertex_id);
 
+    args.sort_mode = SORT_MODE::LOCALITY;
+    reference_impl locality_graph(args, max_vertex_id);
+
+    args.sort_mode = SORT_MODE::HYBRID;
+    reference_impl hybrid_graph(args, max_vertex_id);
+
+    // Unsorted, with duplicates combined in a hash table
+    args.sort_mode = SORT_MODE::UNSORTED;
+    reference_impl aggregated_graph(args, max_vertex_id);
+
     auto values_match = [](int64_t a, int64_t b, int64_t c) { return a == b && b == c; };
 
     // Make sure the resulting graphs are the same in each batch, regardless of sort mode
@@ -169,6 +376,9 @@ TEST_P(SortModeTest, SortModeDoesntAffectEdgeCount)
 
         unsorted_graph.delete_edges_older_than(unsorted_threshold);
         presort_graph.delete_edges_older_than(presort_threshold);
+        locality_graph.delete_edges_older_than(unsorted_threshold);
+        hybrid_graph.delete_edges_older_than(unsorted_threshold);
+        aggregated_graph.delete_edges_older_than(unsorted_threshold);
 
         ASSERT_EQ(unsorted_graph.get_num_edges(), presort_graph.get_num_edges());
         ASSERT_EQ(unsorted_graph.get_num_vertices(), presort_graph.get_num_vertices());
@@ -182,6 +392,10 @@ TEST_P(SortModeTest, SortModeDoesntAffectEdgeCount)
         unsorted_graph.insert_batch(*get_preprocessed_batch(batch, dataset, SORT_MODE::UNSORTED));
         presort_graph.insert_batch(*get_preprocessed_batch(batch, dataset, SORT_MODE::PRESORT));
         snapshot_graph.insert_batch(*get_preprocessed_batch(batch, dataset, SORT_MODE::SNAPSHOT));
+        locality_graph.insert_batch(*get_preprocessed_batch(batch, dataset, SORT_MODE::LOCALITY));
+        hybrid_graph.insert_batch(*get_preprocessed_batch(batch, dataset, SORT_MODE::HYBRID));
+        aggregated_graph.insert_batch(*get_preprocessed_batch(batch, dataset, SORT_MODE::UNSORTED,
+            EdgeAggregation(), true));
 
         ASSERT_PRED3(values_match,
             unsorted_graph.get_num_edges(),
@@ -202,6 +416,21 @@ TEST_P(SortModeTest, SortModeDoesntAffectEdgeCount)
                 snapshot_graph.get_out_degree(v)
             );
         }
+        ASSERT_PRED3(values_match,
+            unsorted_graph.get_num_edges(),
+            locality_graph.get_num_edges(),
+            hybrid_graph.get_num_edges()
+        );
+        for (int64_t v = 0; v < unsorted_graph.get_num_vertices(); ++v)
+        {
+            ASSERT_PRED3(values_match,
+                unsorted_graph.get_out_degree(v),
+                locality_graph.get_out_degree(v),
+                hybrid_graph.get_out_degree(v)
+            );
+        }
+        ASSERT_EQ(unsorted_graph.get_num_edges(), aggregated_graph.get_num_edges());
+        ASSERT_EQ(unsorted_graph.get_num_vertices(), aggregated_graph.get_num_vertices());
 
         // Clear out snapshot graph before next batch
         snapshot_graph.~reference_impl();
@@ -209,6 +438,521 @@ TEST_P(SortModeTest, SortModeDoesntAffectEdgeCount)
     }
 }
 
+// Deleting just the expired edges should have the same effect as scanning the whole graph
+TEST_P(SortModeTest, DeleteExpiredEdgesMatchesFullScan)
+{
+    DynoGraph::Args args = GetParam();
+    for (bool undirected : { false, true }) {
+        args.undirected = undirected;
+        DynoGraph::EdgeListDataset dataset(args);
+        int64_t max_vertex_id = dataset.getMaxVertexId();
+        reference_impl scan_graph(args, max_vertex_id);
+        reference_impl expired_graph(args, max_vertex_id);
+
+        for (int64_t batch = 0; batch < dataset.getNumBatches(); ++batch)
+        {
+            int64_t threshold = dataset.getTimestampForWindow(batch);
+            scan_graph.delete_edges_older_than(threshold);
+            expired_graph.delete_batch(*get_expired_edges(batch, dataset), threshold);
+
+            ASSERT_EQ(scan_graph.get_num_edges(), expired_graph.get_num_edges());
+            ASSERT_EQ(scan_graph.get_num_vertices(), expired_graph.get_num_vertices());
+
+            auto b = get_preprocessed_batch(batch, dataset, Args::SORT_MODE::UNSORTED);
+            scan_graph.insert_batch(*b);
+            expired_graph.insert_batch(*b);
+        }
+    }
+}
+
+// Preprocessing the whole dataset up front should produce the same batches as preprocessing them one at a time
+TEST_P(SortModeTest, PresortedBatchesMatchPerBatchPreprocessing)
+{
+    typedef DynoGraph::Args::SORT_MODE SORT_MODE;
+    DynoGraph::Args args = GetParam();
+    DynoGraph::EdgeListDataset dataset(args);
+
+    for (SORT_MODE sort_mode : {SORT_MODE::UNSORTED, SORT_MODE::PRESORT, SORT_MODE::LOCALITY, SORT_MODE::HYBRID})
+    {
+        args.sort_mode = sort_mode;
+        auto presorted = presort_batches(dataset, args);
+        ASSERT_EQ(presorted.size(), dataset.getNumBatches());
+        for (int64_t batch_id = 0; batch_id < dataset.getNumBatches(); ++batch_id)
+        {
+            auto expected = get_preprocessed_batch(batch_id, dataset, sort_mode);
+            const Batch& actual = *presorted[batch_id];
+            ASSERT_EQ(actual.size(), expected->size());
+            for (size_t i = 0; i < actual.size(); ++i) {
+                ASSERT_EQ(actual[i].src, (*expected)[i].src);
+                ASSERT_EQ(actual[i].dst, (*expected)[i].dst);
+                ASSERT_EQ(actual[i].weight, (*expected)[i].weight);
+                ASSERT_EQ(actual[i].timestamp, (*expected)[i].timestamp);
+            }
+        }
+    }
+}
+
+// The degree tracker should pick the same source vertices as the graph, as batches come and go
+TEST_P(SortModeTest, TrackedSourcesMatchGraph)
+{
+    DynoGraph::Args args = GetParam();
+    DynoGraph::EdgeListDataset dataset(args);
+    reference_impl graph(args, dataset.getMaxVertexId());
+    DegreeTracker tracker;
+
+    for (int64_t batch = 0; batch < dataset.getNumBatches(); ++batch)
+    {
+        // Use the list of expired edges every other batch, to cover both ways of deleting edges
+        int64_t threshold = dataset.getTimestampForWindow(batch);
+        std::shared_ptr<Batch> expired = dataset.getExpiredEdges(batch);
+        if (batch % 2 == 0 && expired) {
+            graph.delete_batch(*expired, threshold);
+            tracker.delete_batch(graph, *expired);
+        } else {
+            graph.delete_edges_older_than(threshold);
+            tracker.delete_edges_older_than();
+        }
+        auto inserted = get_preprocessed_batch(batch, dataset, Args::SORT_MODE::UNSORTED);
+        graph.insert_batch(*inserted);
+        tracker.insert_batch(graph, *inserted);
+
+        // The tracker only knows about vertices with outgoing edges, so leave out any the graph picked without them
+        int64_t n = std::min(graph.get_num_vertices(), static_cast<int64_t>(64));
+        std::vector<int64_t> expected = graph.get_high_degree_vertices(n);
+        expected.erase(std::remove_if(expected.begin(), expected.end(),
+            [&](int64_t v) { return graph.get_out_degree(v) == 0; }), expected.end());
+        std::vector<int64_t> actual = tracker.get_high_degree_vertices(graph, n);
+        ASSERT_EQ(actual, expected);
+    }
+}
+
+// In undirected mode, every edge in the batch should appear in both directions, with the same weight
+TEST_P(SortModeTest, UndirectedBatchesAreSymmetric)
+{
+    typedef DynoGraph::Args::SORT_MODE SORT_MODE;
+    DynoGraph::Args args = GetParam();
+    args.undirected = true;
+    DynoGraph::EdgeListDataset dataset(args);
+    ASSERT_FALSE(dataset.isDirected());
+
+    int64_t num_batches = dataset.getNumBatches();
+    int64_t step = std::max(num_batches / 5, static_cast<int64_t>(1));
+    for (SORT_MODE sort_mode : {SORT_MODE::PRESORT, SORT_MODE::SNAPSHOT, SORT_MODE::LOCALITY, SORT_MODE::HYBRID})
+    {
+        for (int64_t batch_id = 0; batch_id < num_batches; batch_id += step)
+        {
+            auto batch = get_preprocessed_batch(batch_id, dataset, sort_mode);
+            EXPECT_FALSE(batch->is_directed());
+            std::map<std::pair<int64_t, int64_t>, int64_t> weights;
+            for (const Edge& e : *batch) {
+                ASSERT_TRUE(weights.emplace(std::make_pair(e.src, e.dst), e.weight).second);
+            }
+            for (const Edge& e : *batch) {
+                auto reverse = weights.find(std::make_pair(e.dst, e.src));
+                ASSERT_NE(reverse, weights.end());
+                ASSERT_EQ(reverse->second, e.weight);
+            }
+        }
+    }
+}
+
+// Merging batches into a snapshot one epoch at a time should match building the snapshot from scratch
+TEST_P(SortModeTest, IncrementalSnapshotMatchesRebuild)
+{
+    DynoGraph::Args args = GetParam();
+    args.sort_mode = Args::SORT_MODE::SNAPSHOT;
+    for (std::string input_path : { "data/worldcup-10K.graph.bin", "0.55-0.20-0.10-0.15-44500-8K.rmat" }) {
+        args.input_path = input_path;
+        std::shared_ptr<IDataset> dataset = create_dataset(args);
+        SnapshotBuilder incremental;
+        // Without the degree sort, snapshots stay in the order they were merged in
+        SnapshotBuilder source_order(EdgeAggregation(), false);
+
+        int64_t num_batches = dataset->getNumBatches();
+        int64_t step = std::max(num_batches / 20, static_cast<int64_t>(1));
+        for (int64_t batch = 0; batch < num_batches; batch += step)
+        {
+            int64_t threshold = dataset->getTimestampForWindow(batch);
+            auto merged = incremental.get_snapshot(*dataset, batch, threshold);
+            // Rebuild the snapshot from scratch, the way it was done before it was incremental
+            ConcreteBatch rebuilt(*dataset->getBatchesUpTo(batch));
+            rebuilt.filter(threshold);
+            rebuilt.dedup();
+            auto unordered = source_order.get_snapshot(*dataset, batch, threshold);
+            ASSERT_EQ(unordered->size(), rebuilt.size());
+            EXPECT_TRUE(std::equal(unordered->begin(), unordered->end(), rebuilt.begin()));
+            rebuilt.sort_by_out_degree();
+            ASSERT_EQ(merged->size(), rebuilt.size());
+            for (size_t i = 0; i < merged->size(); ++i) {
+                ASSERT_EQ((*merged)[i].src, rebuilt[i].src);
+                ASSERT_EQ((*merged)[i].dst, rebuilt[i].dst);
+                ASSERT_EQ((*merged)[i].weight, rebuilt[i].weight);
+                ASSERT_EQ((*merged)[i].timestamp, rebuilt[i].timestamp);
+            }
+        }
+    }
+}
+
+// Reference graph with a bulk constructor, which counts how many times each alg was run
+class bulk_reference_impl : public reference_impl {
+public:
+    std::map<std::string, int64_t> num_alg_updates;
+
+    bulk_reference_impl(DynoGraph::Args args, int64_t max_vertex_id)
+    : reference_impl(args, max_vertex_id) {}
+    bulk_reference_impl(DynoGraph::Args args, int64_t max_vertex_id, const DynoGraph::Batch& batch)
+    : reference_impl(args, max_vertex_id) { insert_batch(batch); }
+
+    virtual void update_alg(const std::string &alg_name, const std::vector<int64_t> &sources, DynoGraph::Range<int64_t> data)
+    {
+        num_alg_updates[alg_name] += 1;
+    }
+    // Weights can differ, since the graph keeps adding to an edge after its older copies expire
+    bool has_same_edges(const bulk_reference_impl& other) const
+    {
+        if (num_edges != other.num_edges || graph.size() != other.graph.size()) { return false; }
+        for (const auto& vertex : graph) {
+            auto other_vertex = other.graph.find(vertex.first);
+            if (other_vertex == other.graph.end() || other_vertex->second.size() != vertex.second.size()) { return false; }
+            for (const auto& neighbor : vertex.second) {
+                auto other_neighbor = other_vertex->second.find(neighbor.first);
+                if (other_neighbor == other_vertex->second.end()
+                 || other_neighbor->second.weight != neighbor.second.weight
+                 || other_neighbor->second.timestamp != neighbor.second.timestamp) { return false; }
+            }
+        }
+        return true;
+    }
+};
+
+// Order in which the ordered_reference_impl engines built their graphs, by engine id
+std::vector<int64_t> engine_trial_order;
+
+// Reference graph that records when each trial starts, so tests can tell the engines apart
+template<int64_t id>
+class ordered_reference_impl : public bulk_reference_impl {
+public:
+    ordered_reference_impl(DynoGraph::Args args, int64_t max_vertex_id)
+    : bulk_reference_impl(args, max_vertex_id) { engine_trial_order.push_back(id); }
+    ordered_reference_impl(DynoGraph::Args args, int64_t max_vertex_id, const DynoGraph::Batch& batch)
+    : bulk_reference_impl(args, max_vertex_id, batch) { engine_trial_order.push_back(id); }
+};
+
+// Reference graph that drops one edge, like a broken engine would
+class wrong_reference_impl : public bulk_reference_impl {
+public:
+    using bulk_reference_impl::bulk_reference_impl;
+    virtual int64_t get_num_edges() const { return reference_impl::get_num_edges() - 1; }
+};
+
+// Engines that agree should run one after another, or alternate every trial with --interleave-engines
+TEST(MultiEngineTest, RunsEnginesInOrder)
+{
+    for (bool interleave : {false, true}) {
+        Args args = SortModeTest::all_args[0];
+        args.num_trials = 2;
+        args.interleave_engines = interleave;
+        Benchmark benchmark(args, create_dataset(args));
+        engine_trial_order.clear();
+        benchmark.run_engines<ordered_reference_impl<1>, ordered_reference_impl<2>>();
+        std::vector<int64_t> expected = interleave ? std::vector<int64_t>{1, 2, 1, 2} : std::vector<int64_t>{1, 1, 2, 2};
+        EXPECT_EQ(engine_trial_order, expected);
+    }
+}
+
+// An engine that builds a different graph than the others should stop the run
+TEST(MultiEngineTest, DetectsWrongEngine)
+{
+    for (bool interleave : {false, true}) {
+        Args args = SortModeTest::all_args[0];
+        args.num_trials = 2;
+        args.interleave_engines = interleave;
+        Benchmark benchmark(args, create_dataset(args));
+        EXPECT_DEATH((benchmark.run_engines<bulk_reference_impl, wrong_reference_impl>()), "ERROR: at epoch 0");
+    }
+}
+
+// Bulk loading the batches before --start-batch should leave the same graph as inserting them one at a time
+// Duplicate edges are combined within each batch by the aggregation policy, then add up in the graph
+TEST_P(SortModeTest, FastForwardMatchesIncrementalInsertion)
+{
+    DynoGraph::Args args = GetParam();
+    args.sort_mode = Args::SORT_MODE::HYBRID;
+    args.alg_names = {"bfs", "pagerank"};
+    std::vector<EdgeAggregation> aggregations = {
+        {EdgeAggregation::WEIGHT::SUM, EdgeAggregation::TIME::LAST},
+        {EdgeAggregation::WEIGHT::MAX, EdgeAggregation::TIME::FIRST},
+        {EdgeAggregation::WEIGHT::COUNT, EdgeAggregation::TIME::LAST},
+    };
+    for (EdgeAggregation aggregation : aggregations) {
+        for (std::string input_path : { "data/worldcup-10K.graph.bin", "0.55-0.20-0.10-0.15-44500-8K.rmat" }) {
+            args.aggregation = aggregation;
+            args.input_path = input_path;
+            std::shared_ptr<IDataset> dataset = create_dataset(args);
+            int64_t max_vertex_id = dataset->getMaxVertexId();
+            int64_t num_batches = dataset->getNumBatches();
+            args.start_batch = num_batches / 2;
+            if (args.start_batch == 0) { continue; }
+
+            auto insert = [&](reference_impl& graph, IDataset& dataset, int64_t batch_id) {
+                int64_t threshold = dataset.getTimestampForWindow(batch_id);
+                auto batch = get_preprocessed_batch(batch_id, dataset, args.sort_mode, args.aggregation, args.aggregate);
+                graph.delete_edges_older_than(threshold);
+                graph.insert_batch(*batch);
+            };
+
+            // Insert every batch into the reference graph, using a separate copy of the dataset
+            std::shared_ptr<IDataset> reference_dataset = create_dataset(args);
+            bulk_reference_impl incremental(args, max_vertex_id);
+            for (int64_t batch_id = 0; batch_id < args.start_batch; ++batch_id) {
+                insert(incremental, *reference_dataset, batch_id);
+            }
+
+            // Let the benchmark build the graph from the prefix, then continue from the same dataset
+            Benchmark benchmark(args, dataset);
+            std::unique_ptr<bulk_reference_impl> fast_forwarded(benchmark.fast_forward<bulk_reference_impl>());
+            ASSERT_TRUE(fast_forwarded->has_same_edges(incremental));
+            for (std::string alg_name : args.alg_names) {
+                EXPECT_EQ(fast_forwarded->num_alg_updates[alg_name], 1);
+            }
+
+            for (int64_t batch_id = args.start_batch; batch_id < num_batches; ++batch_id) {
+                insert(incremental, *reference_dataset, batch_id);
+                insert(*fast_forwarded, *dataset, batch_id);
+            }
+            EXPECT_TRUE(fast_forwarded->has_same_edges(incremental));
+            EXPECT_EQ(fast_forwarded->get_high_degree_vertices(16), incremental.get_high_degree_vertices(16));
+        }
+    }
+}
+
+// Reference graph that takes a lock around every operation, so algs can run while batches are inserted
+// Counts the alg runs across every instance, since the driver creates and destroys the graph itself
+class concurrent_reference_impl : public bulk_reference_impl {
+private:
+    mutable std::mutex mutex;
+public:
+    static std::atomic<int64_t> num_alg_updates;
+
+    concurrent_reference_impl(DynoGraph::Args args, int64_t max_vertex_id)
+    : bulk_reference_impl(args, max_vertex_id) {}
+    concurrent_reference_impl(DynoGraph::Args args, int64_t max_vertex_id, const DynoGraph::Batch& batch)
+    : bulk_reference_impl(args, max_vertex_id, batch) {}
+
+    virtual bool supports_concurrent_reads() const { return true; }
+    virtual void delete_edges_older_than(int64_t threshold)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reference_impl::delete_edges_older_than(threshold);
+    }
+    virtual void delete_batch(const DynoGraph::Batch& batch, int64_t threshold)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        reference_impl::delete_batch(batch, threshold);
+    }
+    virtual void insert_batch(const DynoGraph::Batch& batch)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            reference_impl::insert_batch(batch);
+        }
+        // Leave the query thread some time to run between batches
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    virtual void update_alg(const std::string &alg_name, const std::vector<int64_t> &sources, DynoGraph::Range<int64_t> data)
+    {
+        num_alg_updates += 1;
+    }
+    virtual int64_t get_out_degree(int64_t vertex_id) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reference_impl::get_out_degree(vertex_id);
+    }
+    virtual std::vector<int64_t> get_high_degree_vertices(int64_t n) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reference_impl::get_high_degree_vertices(n);
+    }
+    virtual int64_t get_num_vertices() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reference_impl::get_num_vertices();
+    }
+    virtual int64_t get_num_edges() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return reference_impl::get_num_edges();
+    }
+};
+std::atomic<int64_t> concurrent_reference_impl::num_alg_updates(0);
+
+// Opens up the parts of the benchmark that the driver tests look at
+class ConcurrentBenchmark : public Benchmark {
+public:
+    ConcurrentBenchmark(Args& args, std::shared_ptr<IDataset> dataset) : Benchmark(args, dataset) {}
+    using Benchmark::run_queries;
+    using Benchmark::epoch_graph_sizes;
+};
+
+// The query thread should run the algs at each interval until told to stop, counting each round
+TEST(ConcurrentDriverTest, RunsQueriesUntilStopped)
+{
+    Args args = SortModeTest::all_args[0];
+    args.alg_names = {"bfs", "pagerank"};
+    args.query_interval_ms = 1;
+    std::shared_ptr<IDataset> dataset = create_dataset(args);
+    ConcurrentBenchmark benchmark(args, dataset);
+    concurrent_reference_impl graph(args, dataset->getMaxVertexId());
+    // Load enough edges that there are sources to pick for bfs
+    graph.insert_batch(*dataset->getBatchesUpTo(dataset->getNumBatches() / 2));
+    concurrent_reference_impl::num_alg_updates = 0;
+
+    QueryControl control;
+    LatencyHistogram latency("query");
+    std::future<int64_t> queries = std::async(std::launch::async, &ConcurrentBenchmark::run_queries, &benchmark,
+        std::ref(graph), std::ref(control), std::ref(latency));
+    for (int i = 0; i < 5000 && concurrent_reference_impl::num_alg_updates < 6; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    control.stop();
+    int64_t num_queries = queries.get();
+    EXPECT_GE(num_queries, 3);
+    // Every round runs each alg once, and records its latency
+    EXPECT_EQ(concurrent_reference_impl::num_alg_updates, num_queries * 2);
+    EXPECT_EQ(latency.get_count(), static_cast<uint64_t>(num_queries));
+
+    // Stopping before the first interval is up shouldn't run any queries, or wait out the interval
+    args.query_interval_ms = 3600 * 1000;
+    ConcurrentBenchmark idle_benchmark(args, dataset);
+    QueryControl idle_control;
+    std::future<int64_t> idle_queries = std::async(std::launch::async, &ConcurrentBenchmark::run_queries, &idle_benchmark,
+        std::ref(graph), std::ref(idle_control), std::ref(latency));
+    idle_control.stop();
+    EXPECT_EQ(idle_queries.get(), 0);
+}
+
+// Running algs alongside the insertions shouldn't change the graph that gets built
+TEST(ConcurrentDriverTest, MatchesDynamicDriver)
+{
+    // Pagerank doesn't need sources, which the graph may not have enough of early on
+    Args args = SortModeTest::all_args[1];
+    args.alg_names = {"pagerank"};
+    std::shared_ptr<IDataset> dataset = create_dataset(args);
+    ConcurrentBenchmark dynamic_benchmark(args, dataset);
+    dynamic_benchmark.run_trial<concurrent_reference_impl>(0);
+    GraphSize expected = dynamic_benchmark.epoch_graph_sizes.back();
+
+    args.query_interval_ms = 1;
+    concurrent_reference_impl::num_alg_updates = 0;
+    ConcurrentBenchmark concurrent_benchmark(args, dataset);
+    concurrent_benchmark.run_trial<concurrent_reference_impl>(0);
+    ASSERT_EQ(concurrent_benchmark.epoch_graph_sizes.size(), 1);
+    EXPECT_EQ(concurrent_benchmark.epoch_graph_sizes[0].num_vertices, expected.num_vertices);
+    EXPECT_EQ(concurrent_benchmark.epoch_graph_sizes[0].num_edges, expected.num_edges);
+    EXPECT_GT(concurrent_reference_impl::num_alg_updates, 0);
+}
+
+// Graphs that don't opt in to concurrent reads should be turned away
+TEST(ConcurrentDriverTest, RequiresConcurrentReads)
+{
+    Args args = SortModeTest::all_args[0];
+    args.query_interval_ms = 1;
+    std::shared_ptr<IDataset> dataset = create_dataset(args);
+    ConcurrentBenchmark benchmark(args, dataset);
+    EXPECT_DEATH(benchmark.run_trial<bulk_reference_impl>(0), "does not support");
+}
+
+// The concurrent driver can't be combined with the options that only the dynamic driver supports
+TEST(ConcurrentDriverTest, ArgValidation)
+{
+    Args args = SortModeTest::all_args[0];
+    args.query_interval_ms = 10;
+    EXPECT_EQ(args.validate(), "");
+    for (int i = 0; i < 2; ++i) {
+        Args invalid = args;
+        if (i == 0) { invalid.batch_stats = true; } else { invalid.track_sources = true; }
+        EXPECT_NE(invalid.validate(), "");
+    }
+}
+
+// Preparing batches on a producer thread shouldn't change the graph that gets built
+TEST(PipelineDriverTest, MatchesSerialDriver)
+{
+    Args args = SortModeTest::all_args[0];
+    args.num_epochs = 5;
+    args.batch_stats = true;
+    for (Args::SORT_MODE sort_mode : {Args::SORT_MODE::UNSORTED, Args::SORT_MODE::HYBRID}) {
+        args.sort_mode = sort_mode;
+        args.pipeline_threads = 0;
+        std::shared_ptr<IDataset> dataset = create_dataset(args);
+        ConcurrentBenchmark serial_benchmark(args, dataset);
+        serial_benchmark.run_trial<bulk_reference_impl>(0);
+        ASSERT_EQ(serial_benchmark.epoch_graph_sizes.size(), static_cast<size_t>(args.num_epochs));
+
+        for (int64_t pipeline_threads : {1, 2}) {
+            args.pipeline_threads = pipeline_threads;
+            ConcurrentBenchmark pipelined_benchmark(args, dataset);
+            testing::internal::CaptureStderr();
+            pipelined_benchmark.run_trial<bulk_reference_impl>(0);
+            EXPECT_NE(testing::internal::GetCapturedStderr().find("Pipeline producer spent"), std::string::npos);
+            ASSERT_EQ(pipelined_benchmark.epoch_graph_sizes.size(), static_cast<size_t>(args.num_epochs));
+            for (int64_t epoch = 0; epoch < args.num_epochs; ++epoch) {
+                EXPECT_EQ(pipelined_benchmark.epoch_graph_sizes[epoch].num_vertices,
+                    serial_benchmark.epoch_graph_sizes[epoch].num_vertices);
+                EXPECT_EQ(pipelined_benchmark.epoch_graph_sizes[epoch].num_edges,
+                    serial_benchmark.epoch_graph_sizes[epoch].num_edges);
+            }
+        }
+    }
+}
+
+// Reference graph that counts the batches inserted across every instance
+class counting_reference_impl : public bulk_reference_impl {
+public:
+    static int64_t num_insertions;
+
+    counting_reference_impl(DynoGraph::Args args, int64_t max_vertex_id)
+    : bulk_reference_impl(args, max_vertex_id) {}
+    counting_reference_impl(DynoGraph::Args args, int64_t max_vertex_id, const DynoGraph::Batch& batch)
+    : bulk_reference_impl(args, max_vertex_id, batch) {}
+
+    virtual void insert_batch(const DynoGraph::Batch& batch)
+    {
+        num_insertions += 1;
+        reference_impl::insert_batch(batch);
+    }
+};
+int64_t counting_reference_impl::num_insertions = 0;
+
+// Replaying faster than the graph can keep up should coalesce the late batches, without changing the graph
+TEST(ReplayDriverTest, CoalescesLateBatches)
+{
+    Args args = SortModeTest::all_args[0];
+    args.num_epochs = 4;
+    std::shared_ptr<IDataset> dataset = create_dataset(args);
+    ConcurrentBenchmark dynamic_benchmark(args, dataset);
+    dynamic_benchmark.run_trial<counting_reference_impl>(0);
+    std::vector<GraphSize> expected = dynamic_benchmark.epoch_graph_sizes;
+
+    // At this rate, every batch is due as soon as the replay starts, so each epoch is inserted in one update
+    args.replay_rate = 1e15;
+    counting_reference_impl::num_insertions = 0;
+    ConcurrentBenchmark replay_benchmark(args, dataset);
+    testing::internal::CaptureStderr();
+    replay_benchmark.run_trial<counting_reference_impl>(0);
+    std::string log = testing::internal::GetCapturedStderr();
+    EXPECT_EQ(counting_reference_impl::num_insertions, args.num_epochs);
+    ASSERT_EQ(replay_benchmark.epoch_graph_sizes.size(), expected.size());
+    for (size_t epoch = 0; epoch < expected.size(); ++epoch) {
+        EXPECT_EQ(replay_benchmark.epoch_graph_sizes[epoch].num_vertices, expected[epoch].num_vertices);
+        EXPECT_EQ(replay_benchmark.epoch_graph_sizes[epoch].num_edges, expected[epoch].num_edges);
+    }
+    // Every batch was late
+    std::ostringstream missed;
+    missed << "Replay missed " << dataset->getNumBatches() << " deadlines";
+    EXPECT_NE(log.find(missed.str()), std::string::npos) << log;
+}
+
 INSTANTIATE_TEST_CASE_P(SortModeDoesntAffectEdgeCount, SortModeTest, ::testing::ValuesIn(SortModeTest::all_args));
 
 int main(int argc, char **argv)
@@ -22,6 +22,39 @@ operator==(const Edge& a, const Edge& b)
         && a.timestamp == b.timestamp;
 }
 
+// Policy for combining duplicate edges (same src and dst) into one
+// The zero-initialized policy matches what happens when duplicates are inserted into the graph one at a time
+struct EdgeAggregation
+{
+    enum class WEIGHT {
+        // Add up the weights
+        SUM,
+        // Keep the largest weight
+        MAX,
+        // Weight is the number of duplicates
+        COUNT
+    } weight;
+    enum class TIME {
+        // Keep the most recent timestamp
+        LAST,
+        // Keep the oldest timestamp
+        FIRST
+    } time;
+
+    // Policy for combining edges that have already been aggregated, e.g. when merging a batch into a snapshot
+    EdgeAggregation for_partials() const
+    {
+        return {weight == WEIGHT::COUNT ? WEIGHT::SUM : weight, time};
+    }
+};
+
+// Orders edges by src, then by dst
+inline bool
+by_src_dst(const Edge& a, const Edge& b)
+{
+    return (a.src != b.src) ? a.src < b.src : a.dst < b.dst;
+}
+
 inline std::ostream&
 operator<<(std::ostream &os, const Edge &e) {
     os << e.src << " " << e.dst << " " << e.weight << " " << e.timestamp;
@@ -0,0 +1,236 @@
+#include "edge_kernels.h"
+#include "helpers.h"
+#include "pvector.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+using namespace DynoGraph;
+
+namespace {
+
+void
+merge_bounds(EdgeBounds& a, const EdgeBounds& b)
+{
+    a.min.src = std::min(a.min.src, b.min.src);
+    a.min.dst = std::min(a.min.dst, b.min.dst);
+    a.min.weight = std::min(a.min.weight, b.min.weight);
+    a.min.timestamp = std::min(a.min.timestamp, b.min.timestamp);
+    a.max.src = std::max(a.max.src, b.max.src);
+    a.max.dst = std::max(a.max.dst, b.max.dst);
+    a.max.weight = std::max(a.max.weight, b.max.weight);
+    a.max.timestamp = std::max(a.max.timestamp, b.max.timestamp);
+}
+
+EdgeBounds
+find_edge_bounds_scalar(const Edge* edges, int64_t n)
+{
+    EdgeBounds bounds = {edges[0], edges[0]};
+    for (int64_t i = 1; i < n; ++i) {
+        merge_bounds(bounds, {edges[i], edges[i]});
+    }
+    return bounds;
+}
+
+int64_t
+compact_by_timestamp_scalar(Edge* edges, int64_t n, int64_t threshold)
+{
+    int64_t out = 0;
+    for (int64_t i = 0; i < n; ++i) {
+        if (edges[i].timestamp >= threshold) { edges[out++] = edges[i]; }
+    }
+    return out;
+}
+
+#if defined(__x86_64__)
+
+// Each edge is four 64-bit fields, so it fits in one AVX2 register, and two fit in an AVX-512 register.
+// The bounds are computed field by field across the lanes, then the lanes are reduced at the end.
+
+__attribute__((target("avx2")))
+EdgeBounds
+find_edge_bounds_avx2(const Edge* edges, int64_t n)
+{
+    const __m256i* p = reinterpret_cast<const __m256i*>(edges);
+    __m256i lo = _mm256_loadu_si256(p);
+    __m256i hi = lo;
+    for (int64_t i = 1; i < n; ++i) {
+        __m256i v = _mm256_loadu_si256(p + i);
+        lo = _mm256_blendv_epi8(lo, v, _mm256_cmpgt_epi64(lo, v));
+        hi = _mm256_blendv_epi8(hi, v, _mm256_cmpgt_epi64(v, hi));
+    }
+    EdgeBounds bounds;
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&bounds.min), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&bounds.max), hi);
+    return bounds;
+}
+
+__attribute__((target("avx512f")))
+EdgeBounds
+find_edge_bounds_avx512(const Edge* edges, int64_t n)
+{
+    // Start both halves from the first edge, so an odd count can be handled the same way
+    __m512i lo = _mm512_broadcast_i64x4(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges)));
+    __m512i hi = lo;
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m512i v = _mm512_loadu_si512(edges + i);
+        lo = _mm512_min_epi64(lo, v);
+        hi = _mm512_max_epi64(hi, v);
+    }
+    if (i < n) {
+        __m512i v = _mm512_broadcast_i64x4(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges + i)));
+        lo = _mm512_min_epi64(lo, v);
+        hi = _mm512_max_epi64(hi, v);
+    }
+    Edge lanes[4];
+    _mm512_storeu_si512(lanes, lo);
+    _mm512_storeu_si512(lanes + 2, hi);
+    EdgeBounds bounds = {lanes[0], lanes[2]};
+    merge_bounds(bounds, {lanes[1], lanes[3]});
+    return bounds;
+}
+
+__attribute__((target("avx2")))
+int64_t
+compact_by_timestamp_avx2(Edge* edges, int64_t n, int64_t threshold)
+{
+    // Compare the timestamps of four edges at a time, then store each edge and advance the output only if it was kept
+    // The output never passes the input, so the edges can be written back in place
+    if (threshold == std::numeric_limits<int64_t>::min()) { return n; }
+    const __m256i limit = _mm256_set1_epi64x(threshold - 1);
+    const __m256i timestamp_offsets = _mm256_set_epi64x(15, 11, 7, 3);
+    __m256i* in = reinterpret_cast<__m256i*>(edges);
+    __m256i* out = in;
+    int64_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i ts = _mm256_i64gather_epi64(reinterpret_cast<const long long*>(in + i), timestamp_offsets, 8);
+        int keep = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(ts, limit)));
+        __m256i e0 = _mm256_loadu_si256(in + i);
+        __m256i e1 = _mm256_loadu_si256(in + i + 1);
+        __m256i e2 = _mm256_loadu_si256(in + i + 2);
+        __m256i e3 = _mm256_loadu_si256(in + i + 3);
+        _mm256_storeu_si256(out, e0); out += keep & 1;
+        _mm256_storeu_si256(out, e1); out += (keep >> 1) & 1;
+        _mm256_storeu_si256(out, e2); out += (keep >> 2) & 1;
+        _mm256_storeu_si256(out, e3); out += (keep >> 3) & 1;
+    }
+    int64_t num_kept = out - in;
+    for (; i < n; ++i) {
+        if (edges[i].timestamp >= threshold) { edges[num_kept++] = edges[i]; }
+    }
+    return num_kept;
+}
+
+__attribute__((target("avx512f")))
+int64_t
+compact_by_timestamp_avx512(Edge* edges, int64_t n, int64_t threshold)
+{
+    // Compare two edges at a time, widen the timestamp comparison to cover all four fields of each edge,
+    // and let the compress store pack the kept edges into the output
+    const __m512i limit = _mm512_set1_epi64(threshold);
+    int64_t* out = reinterpret_cast<int64_t*>(edges);
+    int64_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m512i v = _mm512_loadu_si512(edges + i);
+        unsigned ge = _mm512_cmpge_epi64_mask(v, limit);
+        __mmask8 keep = static_cast<__mmask8>((-((ge >> 3) & 1) & 0x0F) | (-((ge >> 7) & 1) & 0xF0));
+        _mm512_mask_compressstoreu_epi64(out, keep, v);
+        out += __builtin_popcount(keep);
+    }
+    int64_t num_kept = (out - reinterpret_cast<int64_t*>(edges)) / 4;
+    for (; i < n; ++i) {
+        if (edges[i].timestamp >= threshold) { edges[num_kept++] = edges[i]; }
+    }
+    return num_kept;
+}
+
+#endif
+
+EdgeBounds
+find_edge_bounds_serial(const Edge* edges, int64_t n, SIMD_LEVEL level)
+{
+    switch (level) {
+#if defined(__x86_64__)
+        case SIMD_LEVEL::AVX512: return find_edge_bounds_avx512(edges, n);
+        case SIMD_LEVEL::AVX2: return find_edge_bounds_avx2(edges, n);
+#endif
+        default: return find_edge_bounds_scalar(edges, n);
+    }
+}
+
+int64_t
+compact_by_timestamp_serial(Edge* edges, int64_t n, int64_t threshold, SIMD_LEVEL level)
+{
+    switch (level) {
+#if defined(__x86_64__)
+        case SIMD_LEVEL::AVX512: return compact_by_timestamp_avx512(edges, n, threshold);
+        case SIMD_LEVEL::AVX2: return compact_by_timestamp_avx2(edges, n, threshold);
+#endif
+        default: return compact_by_timestamp_scalar(edges, n, threshold);
+    }
+}
+
+} // end anonymous namespace
+
+SIMD_LEVEL
+DynoGraph::get_simd_level()
+{
+#if defined(__x86_64__)
+    static const SIMD_LEVEL level =
+        __builtin_cpu_supports("avx512f") ? SIMD_LEVEL::AVX512
+      : __builtin_cpu_supports("avx2") ? SIMD_LEVEL::AVX2
+      : SIMD_LEVEL::SCALAR;
+    return level;
+#else
+    return SIMD_LEVEL::SCALAR;
+#endif
+}
+
+EdgeBounds
+DynoGraph::find_edge_bounds(const Edge* edges, int64_t num_edges, SIMD_LEVEL level)
+{
+    // Each chunk finds its own bounds, then they are combined
+    int64_t num_chunks = std::min(get_num_chunks(), num_edges);
+    pvector<EdgeBounds> chunk_bounds(num_chunks);
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t begin = num_edges * c / num_chunks;
+        int64_t end = num_edges * (c+1) / num_chunks;
+        chunk_bounds[c] = find_edge_bounds_serial(edges + begin, end - begin, level);
+    }
+    EdgeBounds bounds = chunk_bounds[0];
+    for (int64_t c = 1; c < num_chunks; ++c) {
+        merge_bounds(bounds, chunk_bounds[c]);
+    }
+    return bounds;
+}
+
+int64_t
+DynoGraph::compact_by_timestamp(Edge* edges, int64_t num_edges, int64_t threshold, SIMD_LEVEL level)
+{
+    // Compact each chunk in place
+    int64_t num_chunks = get_num_chunks();
+    pvector<int64_t> chunk_size(num_chunks);
+    #pragma omp parallel for schedule(static, 1)
+    for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t begin = num_edges * c / num_chunks;
+        int64_t end = num_edges * (c+1) / num_chunks;
+        chunk_size[c] = compact_by_timestamp_serial(edges + begin, end - begin, threshold, level);
+    }
+
+    // Slide each chunk's results down to close the gaps, in order
+    int64_t num_kept = chunk_size[0];
+    for (int64_t c = 1; c < num_chunks; ++c) {
+        int64_t begin = num_edges * c / num_chunks;
+        if (num_kept != begin) {
+            std::memmove(edges + num_kept, edges + begin, chunk_size[c] * sizeof(Edge));
+        }
+        num_kept += chunk_size[c];
+    }
+    return num_kept;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "edge.h"
+#include <cinttypes>
+
+namespace DynoGraph {
+
+// Vectorized kernels over arrays of edges
+// Each kernel runs in parallel over chunks of the array, and uses the widest instruction set
+// the CPU supports (checked at runtime), so the preprocessing passes stay bandwidth bound.
+
+// Instruction sets that the kernels can use
+enum class SIMD_LEVEL { SCALAR, AVX2, AVX512 };
+
+// Returns the widest instruction set supported by this CPU
+SIMD_LEVEL get_simd_level();
+
+// Smallest and largest value of each field, over a list of edges
+struct EdgeBounds
+{
+    Edge min;
+    Edge max;
+};
+
+// Returns the bounds of each field over the edges. The list must not be empty.
+EdgeBounds find_edge_bounds(const Edge* edges, int64_t num_edges, SIMD_LEVEL level = get_simd_level());
+
+// Moves the edges with a timestamp at or after threshold to the front of the list, keeping their order
+// Returns the number of edges that were kept
+int64_t compact_by_timestamp(Edge* edges, int64_t num_edges, int64_t threshold, SIMD_LEVEL level = get_simd_level());
+
+} // end namespace DynoGraph
@@ -0,0 +1,77 @@
+#include "edge_kernels.h"
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace DynoGraph;
+
+namespace {
+
+std::vector<Edge>
+random_edges(size_t n)
+{
+    std::mt19937_64 rng(n);
+    std::uniform_int_distribution<int64_t> value(-1000, 1000);
+    std::vector<Edge> edges(n);
+    for (Edge& e : edges) {
+        e = {value(rng), value(rng), value(rng), value(rng)};
+    }
+    return edges;
+}
+
+// Returns each instruction set this CPU can run
+std::vector<SIMD_LEVEL>
+supported_levels()
+{
+    std::vector<SIMD_LEVEL> levels = {SIMD_LEVEL::SCALAR};
+    if (get_simd_level() == SIMD_LEVEL::AVX2 || get_simd_level() == SIMD_LEVEL::AVX512) {
+        levels.push_back(SIMD_LEVEL::AVX2);
+    }
+    if (get_simd_level() == SIMD_LEVEL::AVX512) {
+        levels.push_back(SIMD_LEVEL::AVX512);
+    }
+    return levels;
+}
+
+} // end anonymous namespace
+
+// Make sure every instruction set finds the same bounds, including odd sizes and remainders
+TEST(EdgeKernelsTest, FindEdgeBounds) {
+    for (size_t n : {1, 2, 3, 5, 8, 17, 1000}) {
+        std::vector<Edge> edges = random_edges(n);
+        Edge expected_min = edges[0];
+        Edge expected_max = edges[0];
+        for (const Edge& e : edges) {
+            expected_min = {std::min(expected_min.src, e.src), std::min(expected_min.dst, e.dst),
+                std::min(expected_min.weight, e.weight), std::min(expected_min.timestamp, e.timestamp)};
+            expected_max = {std::max(expected_max.src, e.src), std::max(expected_max.dst, e.dst),
+                std::max(expected_max.weight, e.weight), std::max(expected_max.timestamp, e.timestamp)};
+        }
+        for (SIMD_LEVEL level : supported_levels()) {
+            EdgeBounds bounds = find_edge_bounds(edges.data(), n, level);
+            EXPECT_EQ(bounds.min, expected_min);
+            EXPECT_EQ(bounds.max, expected_max);
+        }
+    }
+}
+
+// Make sure compaction keeps the edges inside the window, in their original order
+TEST(EdgeKernelsTest, CompactByTimestamp) {
+    for (size_t n : {0, 1, 2, 3, 5, 8, 17, 1000}) {
+        for (int64_t threshold : {std::numeric_limits<int64_t>::min(), int64_t(-500), int64_t(0), int64_t(2000)}) {
+            std::vector<Edge> edges = random_edges(n);
+            std::vector<Edge> expected;
+            for (const Edge& e : edges) {
+                if (e.timestamp >= threshold) { expected.push_back(e); }
+            }
+            for (SIMD_LEVEL level : supported_levels()) {
+                std::vector<Edge> actual = edges;
+                int64_t num_kept = compact_by_timestamp(actual.data(), n, threshold, level);
+                ASSERT_EQ(num_kept, static_cast<int64_t>(expected.size()));
+                actual.resize(num_kept);
+                EXPECT_EQ(actual, expected);
+            }
+        }
+    }
+}
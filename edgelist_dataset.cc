@@ -16,7 +16,7 @@ using std::shared_ptr;
 using std::make_shared;
 
 EdgeListDataset::EdgeListDataset(Args args)
-        : args(args), directed(true)
+        : args(args), directed(!args.undirected)
 {
 
     Logger &logger = Logger::get_instance();
@@ -32,26 +32,6 @@ EdgeListDataset::EdgeListDataset(Args args)
         die();
     }
 
-    // Intentionally rounding down to make it divide evenly
-    int64_t num_batches = edges.size() / args.batch_size;
-
-    // Sanity check on arguments
-    if (static_cast<size_t>(args.batch_size) > edges.size())
-    {
-        logger << "Invalid arguments: batch size (" << args.batch_size << ") "
-               << "cannot be larger than the total number of edges in the dataset "
-               << " (" << edges.size() << ")\n";
-        die();
-    }
-
-    if (args.num_epochs > num_batches)
-    {
-        logger << "Invalid arguments: number of epochs (" << args.num_epochs << ") "
-               << "cannot be greater than the number of batches in the dataset "
-               << "(" << num_batches << ")\n";
-        die();
-    }
-
     // Calculate max vertex id so engines can statically provision the vertex array
     max_vertex_id = Batch(edges).max_vertex_id();
 
@@ -74,6 +54,35 @@ EdgeListDataset::EdgeListDataset(Args args)
         die();
     }
 
+    sliceBatches();
+}
+
+void
+EdgeListDataset::sliceBatches()
+{
+    Logger &logger = Logger::get_instance();
+
+    // Intentionally rounding down to make it divide evenly
+    int64_t num_batches = edges.size() / args.batch_size;
+
+    // Sanity check on arguments
+    if (static_cast<size_t>(args.batch_size) > edges.size())
+    {
+        logger << "Invalid arguments: batch size (" << args.batch_size << ") "
+               << "cannot be larger than the total number of edges in the dataset "
+               << " (" << edges.size() << ")\n";
+        die();
+    }
+
+    if (args.num_epochs > num_batches)
+    {
+        logger << "Invalid arguments: number of epochs (" << args.num_epochs << ") "
+               << "cannot be greater than the number of batches in the dataset "
+               << "(" << num_batches << ")\n";
+        die();
+    }
+
+    batches.clear();
     for (int i = 0; i < num_batches; ++i)
     {
         size_t offset = i * args.batch_size;
@@ -83,6 +92,16 @@ EdgeListDataset::EdgeListDataset(Args args)
     }
 }
 
+bool
+EdgeListDataset::reconfigure(const Args& new_args)
+{
+    // The edges can only be reused if they would be loaded the same way
+    if (new_args.input_path != args.input_path || new_args.undirected != args.undirected) { return false; }
+    args = new_args;
+    sliceBatches();
+    return true;
+}
+
 // Count the number of lines in a text file
 int64_t
 count_lines(string path)
@@ -240,6 +259,20 @@ EdgeListDataset::getBatchesUpTo(int64_t batchId)
     return make_shared<Batch>(&*edges.begin(), batches[batchId].end());
 }
 
+shared_ptr<Batch>
+EdgeListDataset::getExpiredEdges(int64_t batchId)
+{
+    // Edges between the window threshold of the previous batch and this one have expired
+    int64_t begin_time = batchId == 0 ? min_timestamp : getTimestampForWindow(batchId - 1);
+    int64_t end_time = getTimestampForWindow(batchId);
+    auto by_timestamp = [](const Edge& a, const Edge& b) { return a.timestamp < b.timestamp; };
+    Edge* first = &*edges.begin();
+    Edge* last = batches[batchId].end();
+    Edge* expired_begin = std::lower_bound(first, last, Edge{0, 0, 0, begin_time}, by_timestamp);
+    Edge* expired_end = std::lower_bound(expired_begin, last, Edge{0, 0, 0, end_time}, by_timestamp);
+    return make_shared<Batch>(expired_begin, expired_end);
+}
+
 bool
 EdgeListDataset::isDirected() const
 {
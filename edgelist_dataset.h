@@ -13,6 +13,7 @@ private:
     void loadEdgesBinary(std::string path);
     void loadEdgesAscii(std::string path);
     void loadEdgesCompressed(std::string path);
+    void sliceBatches();
 
     Args args;
     bool directed;
@@ -29,13 +30,18 @@ public:
     int64_t getTimestampForWindow(int64_t batchId) const;
     std::shared_ptr<Batch> getBatch(int64_t batchId);
     std::shared_ptr<Batch> getBatchesUpTo(int64_t batchId);
+    std::shared_ptr<Batch> getExpiredEdges(int64_t batchId);
     int64_t getNumBatches() const;
     int64_t getNumEdges() const;
     int64_t getMinTimestamp() const;
     int64_t getMaxTimestamp() const;
+    // Batches are views of the loaded edges, so their timestamps can be looked up right away
+    bool hasLastTimestamp(int64_t batchId) const { return true; }
 
     bool isDirected() const;
     int64_t getMaxVertexId() const;
+
+    bool reconfigure(const Args& args);
 };
 
 } // end namespace DynoGraph
@@ -0,0 +1,58 @@
+#include "experiment_plan.h"
+#include <fstream>
+#include <stdexcept>
+#include <json.hpp>
+
+using namespace DynoGraph;
+using nlohmann::json;
+using std::string;
+
+namespace {
+
+string
+to_option_string(const json &value)
+{
+    if (value.is_string()) { return value.get<string>(); }
+    return value.dump();
+}
+
+} // end anonymous namespace
+
+std::vector<std::vector<PlanOption>>
+DynoGraph::read_experiment_plan(const string &path)
+{
+    std::ifstream plan_file(path);
+    if (!plan_file) {
+        throw std::runtime_error("Failed to open experiment plan " + path);
+    }
+    json plan;
+    try {
+        plan_file >> plan;
+    } catch (const std::exception &e) {
+        throw std::runtime_error("Failed to parse experiment plan " + path + ": " + e.what());
+    }
+    if (!plan.is_array() || plan.empty()) {
+        throw std::runtime_error("Invalid experiment plan: expected a non-empty list of configurations");
+    }
+
+    std::vector<std::vector<PlanOption>> configs;
+    for (const json &entry : plan)
+    {
+        if (!entry.is_object()) {
+            throw std::runtime_error("Invalid experiment plan: each configuration must be an object of options");
+        }
+        std::vector<PlanOption> options;
+        for (json::const_iterator it = entry.begin(); it != entry.end(); ++it)
+        {
+            std::vector<string> values;
+            if (it.value().is_array()) {
+                for (const json &element : it.value()) { values.push_back(to_option_string(element)); }
+            } else {
+                values.push_back(to_option_string(it.value()));
+            }
+            options.push_back(PlanOption(it.key(), values));
+        }
+        configs.push_back(options);
+    }
+    return configs;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace DynoGraph {
+
+// One option from an experiment plan, e.g. {"batch-size", {"1000"}}
+// Booleans are spelled "true" or "false", and lists hold one string per element
+typedef std::pair<std::string, std::vector<std::string>> PlanOption;
+
+// Reads an experiment plan: a JSON list of configurations, each an object mapping option names to values
+// Throws std::runtime_error if the file can't be read or isn't shaped like a plan
+// This is built apart from the rest of the library, since json.hpp doesn't build against the
+// parallel mode algorithms, so only plain strings cross over
+std::vector<std::vector<PlanOption>>
+read_experiment_plan(const std::string &path);
+
+} // end namespace DynoGraph
@@ -4,6 +4,11 @@
 #include <sstream>
 #include <string>
 #include <cmath>
+#include <cstdint>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 namespace { // anonymous namespace keeps these local
 
@@ -26,6 +31,17 @@ true_div(X x, Y y)
     return static_cast<double>(x) / static_cast<double>(y);
 }
 
+// Number of chunks to use when splitting a loop into per-thread pieces
+inline int64_t
+get_num_chunks()
+{
+#if defined(_OPENMP)
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
 // Helper function to test a string for a given suffix
 // http://stackoverflow.com/questions/20446201
 inline bool
@@ -35,6 +51,22 @@ has_suffix(const string &str, const string &suffix)
            str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
 }
 
+// Parse an integer with an optional binary suffix (K, M, G or T), like "500M"
+inline int64_t
+parse_int_with_suffix(const string &token)
+{
+    int64_t n = static_cast<int64_t>(std::stoll(token));
+    switch(token.back())
+    {
+        case 'K': n *= 1LL << 10; break;
+        case 'M': n *= 1LL << 20; break;
+        case 'G': n *= 1LL << 30; break;
+        case 'T': n *= 1LL << 40; break;
+        default: break;
+    }
+    return n;
+}
+
 // Helper functions to split strings
 // http://stackoverflow.com/a/236803/1877086
 inline void
@@ -4,7 +4,10 @@
 #include <valarray>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <memory>
 #include "json.hpp"
+#include "latency_histogram.h"
 #include "../mpi_macros.h"
 #include "edge_count.h"
 // Helper class to manage edge count hooks
@@ -65,6 +68,10 @@ class Hooks::impl
     json attrs;
     // Dict of custom results that should be printed after the next region_end
     json stats;
+    // Latency histograms for the regions that are summarized rather than printed every time
+    vector<std::unique_ptr<LatencyHistogram>> histograms;
+    // Total milliseconds spent in each region, for comparing runs within the same process
+    std::map<string, double> region_times;
 #if defined(ENABLE_PERF_HOOKS)
     // Names of perf events to collect this run
     vector<string> perf_event_names;
@@ -95,6 +102,30 @@ class Hooks::impl
         }
     }
 
+    static vector<std::unique_ptr<LatencyHistogram>>
+    get_histograms()
+    {
+        vector<std::unique_ptr<LatencyHistogram>> histograms;
+        if (const char* env_names = getenv("HOOKS_HISTOGRAM_REGIONS"))
+        {
+            std::istringstream names(env_names);
+            string name;
+            while (names >> name) {
+                histograms.emplace_back(new LatencyHistogram(name));
+            }
+        }
+        return histograms;
+    }
+
+    LatencyHistogram*
+    find_histogram(const string& name)
+    {
+        for (auto& histogram : histograms) {
+            if (histogram->get_name() == name) { return histogram.get(); }
+        }
+        return nullptr;
+    }
+
 #if defined(ENABLE_PERF_HOOKS)
 
     static vector<string>
@@ -136,6 +167,7 @@ class Hooks::impl
     impl()
      : out(get_output_filename(), std::ofstream::app)
      , region_name("")
+     , histograms(get_histograms())
 #if defined(ENABLE_PERF_HOOKS)
      , perf_event_names(get_perf_event_names())
      , perf_group_size(get_perf_group_size())
@@ -211,6 +243,20 @@ class Hooks::impl
             cerr << "ERROR: called region_end before region_begin\n";
             exit(-1);
         }
+        region_times[region_name] += std::chrono::duration<double, std::milli>(t2-t1).count();
+
+        // Summarized regions just add their time to the histogram
+        if (LatencyHistogram* histogram = find_histogram(region_name))
+        {
+            histogram->record(std::chrono::duration_cast<std::chrono::nanoseconds>(t2-t1).count());
+#ifdef ENABLE_DYNOGRAPH_EDGE_COUNT
+            edge_counter.reset();
+#endif
+            stats.clear();
+            region_name = "";
+            MPI_BARRIER();
+            return;
+        }
 
         // Populate the results object
         json results;
@@ -263,6 +309,40 @@ class Hooks::impl
         region_name = "";
     }
 
+    void
+    write_summary()
+    {
+        for (auto& histogram : histograms)
+        {
+            if (histogram->get_count() == 0) { continue; }
+            json results;
+            results["count"] = histogram->get_count();
+            results["mean_ms"] = histogram->get_mean() / 1e6;
+            results["p50_ms"] = histogram->get_percentile(0.50) / 1e6;
+            results["p99_ms"] = histogram->get_percentile(0.99) / 1e6;
+            results["p99.9_ms"] = histogram->get_percentile(0.999) / 1e6;
+            results["max_ms"] = histogram->get_max() / 1e6;
+            histogram->reset();
+
+            combine_results(results);
+            MPI_RANK_0_ONLY {
+            results["region_name"] = histogram->get_name();
+            for (json::iterator it = attrs.begin(); it != attrs.end(); ++it){
+                results[it.key()] = it.value();
+            }
+            out << std::setw(json_output_indent_level) << results << std::endl;
+            } // end MPI_RANK_0_ONLY
+        }
+    }
+
+    std::map<string, double>
+    take_region_times()
+    {
+        std::map<string, double> times;
+        times.swap(region_times);
+        return times;
+    }
+
     void
     combine_results(json &results)
     {
@@ -349,6 +429,8 @@ void Hooks::set_stat(std::string key, uint64_t value)       { pimpl->set_stat(ke
 void Hooks::set_stat(std::string key, int64_t value)        { pimpl->set_stat(key, value); }
 void Hooks::set_stat(std::string key, double value)         { pimpl->set_stat(key, value); }
 void Hooks::set_stat(std::string key, std::string value)    { pimpl->set_stat(key, value); }
+void Hooks::write_summary()                                 { pimpl->write_summary(); }
+std::map<std::string, double> Hooks::take_region_times()    { return pimpl->take_region_times(); }
 
 // Implementation of C interface
 //
@@ -387,4 +469,10 @@ extern "C" void
 hooks_set_attr_str(const char * key, const char* value)
 {
     Hooks::getInstance().set_attr(key, value);
-}
\ No newline at end of file
+}
+
+extern "C" void
+hooks_write_summary()
+{
+    Hooks::getInstance().write_summary();
+}
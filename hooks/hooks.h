@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include <map>
 
 class Hooks
 {
@@ -22,6 +23,12 @@ public:
     void set_stat(std::string key, int64_t value);
     void set_stat(std::string key, double value);
     void set_stat(std::string key, std::string value);
+    // Regions listed in HOOKS_HISTOGRAM_REGIONS are not written out at every region_end
+    // Instead, their times are collected in a histogram, and this writes out a summary of each one
+    // (count, mean, p50, p99, p99.9 and max) along with the current attributes, then clears them
+    void write_summary();
+    // Returns the total milliseconds spent in each region since the last call, then clears them
+    std::map<std::string, double> take_region_times();
 private:
     Hooks();
     ~Hooks();
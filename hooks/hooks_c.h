@@ -13,6 +13,7 @@ void hooks_set_attr_u64(const char * key, uint64_t value);
 void hooks_set_attr_i64(const char * key, int64_t value);
 void hooks_set_attr_f64(const char * key, double value);
 void hooks_set_attr_str(const char * key, const char* value);
+void hooks_write_summary();
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,80 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram(std::string name)
+: name(name)
+{
+    reset();
+}
+
+uint64_t
+LatencyHistogram::bucket_index(uint64_t ns)
+{
+    if (ns < SUB_BUCKET_COUNT) { return ns; }
+    // Keep the top SUB_BUCKET_BITS bits of the value, and count how many were shifted off
+    uint64_t shift = (63 - __builtin_clzll(ns)) - (SUB_BUCKET_BITS - 1);
+    return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + ((ns >> shift) - SUB_BUCKET_HALF);
+}
+
+uint64_t
+LatencyHistogram::bucket_max(uint64_t index)
+{
+    if (index < SUB_BUCKET_COUNT) { return index; }
+    uint64_t shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF + 1;
+    uint64_t top_bits = (index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF + SUB_BUCKET_HALF;
+    return ((top_bits + 1) << shift) - 1;
+}
+
+void
+LatencyHistogram::record(uint64_t ns)
+{
+    buckets[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t prev = max.load(std::memory_order_relaxed);
+    while (prev < ns && !max.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+}
+
+uint64_t
+LatencyHistogram::get_count() const
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+uint64_t
+LatencyHistogram::get_max() const
+{
+    return max.load(std::memory_order_relaxed);
+}
+
+double
+LatencyHistogram::get_mean() const
+{
+    uint64_t n = get_count();
+    return n == 0 ? 0 : static_cast<double>(total.load(std::memory_order_relaxed)) / n;
+}
+
+uint64_t
+LatencyHistogram::get_percentile(double fraction) const
+{
+    uint64_t n = get_count();
+    if (n == 0) { return 0; }
+    uint64_t rank = std::max(static_cast<uint64_t>(std::ceil(fraction * n)), static_cast<uint64_t>(1));
+    uint64_t seen = 0;
+    for (uint64_t i = 0; i < NUM_BUCKETS; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        // Report the top of the bucket, but never more than the largest sample
+        if (seen >= rank) { return std::min(bucket_max(i), get_max()); }
+    }
+    return get_max();
+}
+
+void
+LatencyHistogram::reset()
+{
+    for (std::atomic<uint64_t>& bucket : buckets) { bucket.store(0, std::memory_order_relaxed); }
+    count.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
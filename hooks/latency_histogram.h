@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Histogram of region latencies, with log-spaced buckets in the style of HdrHistogram
+// Values below 128ns get their own bucket. Above that, each power of two is split into 64 buckets,
+// so a value is reported to within 1/64 of itself.
+// All storage is allocated up front, and recording is a few atomic adds.
+class LatencyHistogram
+{
+public:
+    explicit LatencyHistogram(std::string name);
+    // Name of the region this histogram records
+    const std::string& get_name() const { return name; }
+    // Add one sample, in nanoseconds
+    void record(uint64_t ns);
+    // Number of samples recorded
+    uint64_t get_count() const;
+    // Largest sample recorded, in nanoseconds
+    uint64_t get_max() const;
+    // Mean of the samples, in nanoseconds
+    double get_mean() const;
+    // Smallest value that is at least as large as the given fraction of the samples, in nanoseconds
+    uint64_t get_percentile(double fraction) const;
+    // Forget all samples
+    void reset();
+
+    static const int SUB_BUCKET_BITS = 7;
+    static const uint64_t SUB_BUCKET_COUNT = 1ULL << SUB_BUCKET_BITS;
+    static const uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+    static const uint64_t NUM_BUCKETS = SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF;
+    // Index of the bucket that the value falls into
+    static uint64_t bucket_index(uint64_t ns);
+    // Largest value that falls into the bucket
+    static uint64_t bucket_max(uint64_t index);
+
+private:
+
+    std::string name;
+    std::atomic<uint64_t> buckets[NUM_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> max;
+};
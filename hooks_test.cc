@@ -0,0 +1,87 @@
+// Provides unit tests for the Hooks class
+
+#include <hooks.h>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Hooks reads its settings from the environment the first time it is used, so main points them here
+char output_path[] = "/tmp/hooks_test_XXXXXX";
+
+// Returns the lines written to the output since the last call
+std::vector<std::string>
+read_new_lines()
+{
+    static std::streampos offset = 0;
+    std::ifstream in(output_path);
+    in.seekg(offset);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) { lines.push_back(line); }
+    in.clear();
+    offset = in.tellg();
+    return lines;
+}
+
+bool
+contains(const std::string& line, const std::string& text)
+{
+    return line.find(text) != std::string::npos;
+}
+
+} // end anonymous namespace
+
+// Regions listed in HOOKS_HISTOGRAM_REGIONS are only written out in the summary
+TEST(HooksTest, SummarizesHistogramRegions)
+{
+    Hooks& hooks = Hooks::getInstance();
+    read_new_lines();
+    hooks.set_attr("trial", static_cast<int64_t>(7));
+    for (int i = 0; i < 3; ++i) {
+        hooks.region_begin("query");
+        hooks.region_end();
+    }
+    hooks.set_stat("batch", static_cast<int64_t>(1));
+    hooks.region_begin("insertions");
+    hooks.region_end();
+
+    // Only the ordinary region is written out as it ends
+    std::vector<std::string> lines = read_new_lines();
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_TRUE(contains(lines[0], "\"region_name\":\"insertions\""));
+    EXPECT_TRUE(contains(lines[0], "\"time_ms\":"));
+    EXPECT_TRUE(contains(lines[0], "\"batch\":1"));
+    EXPECT_TRUE(contains(lines[0], "\"trial\":7"));
+
+    hooks.write_summary();
+    lines = read_new_lines();
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_TRUE(contains(lines[0], "\"region_name\":\"query\""));
+    EXPECT_TRUE(contains(lines[0], "\"count\":3"));
+    for (const char* key : {"mean_ms", "p50_ms", "p99_ms", "p99.9_ms", "max_ms"}) {
+        EXPECT_TRUE(contains(lines[0], "\"" + std::string(key) + "\":")) << key;
+    }
+    EXPECT_TRUE(contains(lines[0], "\"trial\":7"));
+
+    // The summary clears the histogram, and empty histograms aren't written out
+    hooks.write_summary();
+    EXPECT_TRUE(read_new_lines().empty());
+}
+
+int main(int argc, char **argv)
+{
+    int fd = mkstemp(output_path);
+    if (fd < 0) { return 1; }
+    close(fd);
+    setenv("HOOKS_FILENAME", output_path, 1);
+    setenv("HOOKS_HISTOGRAM_REGIONS", "query other", 1);
+    ::testing::InitGoogleTest(&argc, argv);
+    int result = RUN_ALL_TESTS();
+    unlink(output_path);
+    return result;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "args.h"
 #include "batch.h"
 #include <memory>
 
@@ -11,6 +12,20 @@ public:
     virtual int64_t getTimestampForWindow(int64_t batchId) const = 0;
     virtual std::shared_ptr<Batch> getBatch(int64_t batchId) = 0;
     virtual std::shared_ptr<Batch> getBatchesUpTo(int64_t batchId) = 0;
+    // Returns the edges that fell out of the window between batchId-1 and batchId, or null if unsupported
+    virtual std::shared_ptr<Batch> getExpiredEdges(int64_t batchId) { return nullptr; }
+    // Returns when the first edge of the batch was received, in seconds on std::chrono::steady_clock,
+    // or a negative value if the dataset was not streamed in
+    virtual double getArrivalTime(int64_t batchId) const { return -1; }
+    // Returns the timestamp of the last edge in the batch
+    // By default this fetches the batch, which may mean generating it or waiting for it to arrive
+    virtual int64_t getLastTimestamp(int64_t batchId)
+    {
+        std::shared_ptr<Batch> batch = getBatch(batchId);
+        return batch->size() > 0 ? (batch->end() - 1)->timestamp : getMinTimestamp();
+    }
+    // Returns true if getLastTimestamp can answer right away, without generating or waiting for the batch
+    virtual bool hasLastTimestamp(int64_t batchId) const { return false; }
     virtual int64_t getNumBatches() const = 0;
     virtual int64_t getNumEdges() const = 0;
     virtual bool isDirected() const = 0;
@@ -18,6 +33,9 @@ public:
     virtual int64_t getMinTimestamp() const = 0;
     virtual int64_t getMaxTimestamp() const = 0;
     virtual void reset() {};
+    // Re-slices the loaded edges into batches for a new configuration, and resets the dataset
+    // Returns false if the dataset must be reloaded instead, e.g. because the input path changed
+    virtual bool reconfigure(const Args& args) { return false; }
     virtual ~IDataset() = default;
 };
 
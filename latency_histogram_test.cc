@@ -0,0 +1,90 @@
+// Provides unit tests for the LatencyHistogram class
+
+#include <latency_histogram.h>
+#include <gtest/gtest.h>
+#include <limits>
+
+// Small values get a bucket each, then each power of two is split into 64 buckets
+TEST(LatencyHistogramTest, BucketEdges)
+{
+    for (uint64_t ns = 0; ns < LatencyHistogram::SUB_BUCKET_COUNT; ++ns) {
+        EXPECT_EQ(LatencyHistogram::bucket_index(ns), ns);
+        EXPECT_EQ(LatencyHistogram::bucket_max(ns), ns);
+    }
+    // Above 128, buckets are two wide, then four wide above 256
+    EXPECT_EQ(LatencyHistogram::bucket_index(128), 128);
+    EXPECT_EQ(LatencyHistogram::bucket_index(129), 128);
+    EXPECT_EQ(LatencyHistogram::bucket_index(130), 129);
+    EXPECT_EQ(LatencyHistogram::bucket_max(128), 129);
+    EXPECT_EQ(LatencyHistogram::bucket_index(255), 191);
+    EXPECT_EQ(LatencyHistogram::bucket_index(256), 192);
+    EXPECT_EQ(LatencyHistogram::bucket_max(192), 259);
+    // The largest value lands in the last bucket
+    uint64_t largest = std::numeric_limits<uint64_t>::max();
+    EXPECT_EQ(LatencyHistogram::bucket_index(largest), LatencyHistogram::NUM_BUCKETS - 1);
+    EXPECT_EQ(LatencyHistogram::bucket_max(LatencyHistogram::NUM_BUCKETS - 1), largest);
+    // Buckets cover the values without gaps
+    for (uint64_t i = 0; i + 1 < LatencyHistogram::NUM_BUCKETS; ++i) {
+        uint64_t top = LatencyHistogram::bucket_max(i);
+        ASSERT_EQ(LatencyHistogram::bucket_index(top), i);
+        ASSERT_EQ(LatencyHistogram::bucket_index(top + 1), i + 1);
+    }
+}
+
+// Every value is reported to within 1/64 of itself
+TEST(LatencyHistogramTest, SubBucketPrecision)
+{
+    for (uint64_t ns = 1; ns < (1ULL << 62); ns = ns * 3 + 1) {
+        for (uint64_t value : {ns, ns + 1, ns * 2 - 1}) {
+            uint64_t top = LatencyHistogram::bucket_max(LatencyHistogram::bucket_index(value));
+            EXPECT_GE(top, value);
+            EXPECT_LE(top - value, value / LatencyHistogram::SUB_BUCKET_HALF);
+        }
+    }
+}
+
+TEST(LatencyHistogramTest, Percentiles)
+{
+    LatencyHistogram histogram("test");
+    for (uint64_t ns = 1; ns <= 100; ++ns) { histogram.record(ns); }
+    // Small values are exact
+    EXPECT_EQ(histogram.get_count(), 100);
+    EXPECT_EQ(histogram.get_percentile(0.50), 50);
+    EXPECT_EQ(histogram.get_percentile(0.99), 99);
+    EXPECT_EQ(histogram.get_percentile(1.0), 100);
+    EXPECT_EQ(histogram.get_max(), 100);
+    EXPECT_DOUBLE_EQ(histogram.get_mean(), 50.5);
+
+    histogram.reset();
+    for (uint64_t ns = 1; ns <= 1000; ++ns) { histogram.record(ns); }
+    // Larger values report the top of their bucket
+    EXPECT_EQ(histogram.get_percentile(0.50), 503);
+    EXPECT_EQ(histogram.get_percentile(0.99), 991);
+    // ...but never more than the largest sample
+    EXPECT_EQ(histogram.get_percentile(1.0), 1000);
+    EXPECT_EQ(histogram.get_max(), 1000);
+
+    // A single outlier shows up in the max, but not the median
+    histogram.reset();
+    for (int i = 0; i < 99; ++i) { histogram.record(10); }
+    histogram.record(1000000);
+    EXPECT_EQ(histogram.get_percentile(0.50), 10);
+    EXPECT_EQ(histogram.get_percentile(0.99), 10);
+    EXPECT_EQ(histogram.get_max(), 1000000);
+}
+
+TEST(LatencyHistogramTest, Empty)
+{
+    LatencyHistogram histogram("test");
+    EXPECT_EQ(histogram.get_name(), "test");
+    EXPECT_EQ(histogram.get_count(), 0);
+    EXPECT_EQ(histogram.get_max(), 0);
+    EXPECT_DOUBLE_EQ(histogram.get_mean(), 0);
+    EXPECT_EQ(histogram.get_percentile(0.50), 0);
+    EXPECT_EQ(histogram.get_percentile(0.99), 0);
+
+    histogram.record(5);
+    histogram.reset();
+    EXPECT_EQ(histogram.get_count(), 0);
+    EXPECT_EQ(histogram.get_percentile(0.50), 0);
+}
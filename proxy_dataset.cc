@@ -40,6 +40,51 @@ ProxyDataset::getBatchesUpTo(int64_t batchId)
 
 }
 
+shared_ptr<Batch>
+ProxyDataset::getExpiredEdges(int64_t batchId)
+{
+    // All ranks need to agree on whether to fall back to a full scan
+    shared_ptr<Batch> batch;
+    bool supported;
+    MPI_RANK_0_ONLY {
+        batch = impl->getExpiredEdges(batchId);
+        supported = (batch != nullptr);
+    }
+    MPI_BROADCAST_RESULT(supported);
+    if (supported && !batch) {
+        // For MPI, ranks other than zero get an empty batch
+        batch = make_shared<Batch>();
+    }
+    return batch;
+}
+
+double
+ProxyDataset::getArrivalTime(int64_t batchId) const
+{
+    double time;
+    MPI_RANK_0_ONLY { time = impl->getArrivalTime(batchId); }
+    MPI_BROADCAST_RESULT(time);
+    return time;
+}
+
+int64_t
+ProxyDataset::getLastTimestamp(int64_t batchId)
+{
+    int64_t timestamp;
+    MPI_RANK_0_ONLY { timestamp = impl->getLastTimestamp(batchId); }
+    MPI_BROADCAST_RESULT(timestamp);
+    return timestamp;
+}
+
+bool
+ProxyDataset::hasLastTimestamp(int64_t batchId) const
+{
+    bool retval;
+    MPI_RANK_0_ONLY { retval = impl->hasLastTimestamp(batchId); }
+    MPI_BROADCAST_RESULT(retval);
+    return retval;
+}
+
 bool
 ProxyDataset::isDirected() const
 {
@@ -95,3 +140,11 @@ ProxyDataset::reset() {
     MPI_RANK_0_ONLY { impl->reset(); }
     MPI_BARRIER();
 }
+
+bool
+ProxyDataset::reconfigure(const Args& args) {
+    bool retval;
+    MPI_RANK_0_ONLY { retval = impl->reconfigure(args); }
+    MPI_BROADCAST_RESULT(retval);
+    return retval;
+}
@@ -14,6 +14,10 @@ public:
     int64_t getTimestampForWindow(int64_t batchId) const;
     std::shared_ptr<Batch> getBatch(int64_t batchId);
     std::shared_ptr<Batch> getBatchesUpTo(int64_t batchId);
+    std::shared_ptr<Batch> getExpiredEdges(int64_t batchId);
+    double getArrivalTime(int64_t batchId) const;
+    int64_t getLastTimestamp(int64_t batchId);
+    bool hasLastTimestamp(int64_t batchId) const;
     int64_t getNumBatches() const;
     int64_t getNumEdges() const;
     bool isDirected() const;
@@ -21,6 +25,7 @@ public:
     int64_t getMinTimestamp() const;
     int64_t getMaxTimestamp() const;
     void reset();
+    bool reconfigure(const Args& args);
 };
 
 }
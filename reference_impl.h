@@ -55,6 +55,23 @@ public:
             }
         }
     }
+    // Delete the listed edges if they are older than <threshold>
+    virtual void delete_batch(const DynoGraph::Batch& batch, int64_t threshold)
+    {
+        for (DynoGraph::Edge e : batch)
+        {
+            adjacency_list::iterator vertex = graph.find(e.src);
+            if (vertex == graph.end()) { continue; }
+            edge_list& neighbors = vertex->second;
+            edge_list::iterator neighbor = neighbors.find(e.dst);
+            if (neighbor != neighbors.end() && neighbor->second.timestamp < threshold) {
+                neighbors.erase(neighbor);
+                --num_edges;
+                // Remove vertex if all out edges are gone
+                if (neighbors.size() == 0) { graph.erase(vertex); }
+            }
+        }
+    }
     // Insert the batch of edges into the graph
     virtual void insert_batch(const DynoGraph::Batch& batch)
     {
@@ -0,0 +1,64 @@
+#include "replay_clock.h"
+#include <algorithm>
+#include <thread>
+
+using namespace DynoGraph;
+
+ReplayClock::ReplayClock(double rate, int64_t first_timestamp)
+: ReplayClock(rate, first_timestamp, clock::now, [](clock::time_point t) { std::this_thread::sleep_until(t); })
+{}
+
+ReplayClock::ReplayClock(double rate, int64_t first_timestamp, now_function now, sleep_function sleep_until)
+: now(now)
+, sleep_until(sleep_until)
+, rate(rate)
+, first_timestamp(first_timestamp)
+, last_timestamp(first_timestamp)
+, start(now())
+, idle_time(clock::duration::zero())
+, lag_ms(0)
+, max_lag_ms(0)
+, num_missed_deadlines(0)
+{}
+
+int64_t
+ReplayClock::wait_for_batch(IDataset &dataset, int64_t batch_id, int64_t last_batch_id)
+{
+    // A batch is complete once its last edge has arrived
+    auto due = [&](int64_t id) {
+        double offset = (dataset.getLastTimestamp(id) - first_timestamp) / rate;
+        return start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(offset));
+    };
+
+    clock::time_point deadline = due(batch_id);
+    clock::time_point current_time = now();
+    // A batch released right at its deadline is on time
+    if (current_time <= deadline) {
+        sleep_until(deadline);
+        idle_time += now() - current_time;
+        lag_ms = 0;
+    } else {
+        lag_ms = std::chrono::duration<double, std::milli>(current_time - deadline).count();
+        max_lag_ms = std::max(max_lag_ms, lag_ms);
+        // Catch up on the batches that arrived while the benchmark was busy
+        // Stop at batches the dataset can't report on without generating them or waiting for them to arrive
+        num_missed_deadlines += 1;
+        while (batch_id < last_batch_id && dataset.hasLastTimestamp(batch_id + 1)) {
+            clock::time_point next_deadline = due(batch_id + 1);
+            if (next_deadline > current_time) { break; }
+            ++batch_id;
+            // Coalesced batches that came due before now missed their own deadlines
+            if (next_deadline < current_time) { num_missed_deadlines += 1; }
+        }
+    }
+    last_timestamp = dataset.getLastTimestamp(batch_id);
+    return batch_id;
+}
+
+double
+ReplayClock::get_sustainable_rate() const
+{
+    double busy_seconds = std::chrono::duration<double>(now() - start - idle_time).count();
+    if (busy_seconds <= 0) { return 0; }
+    return (last_timestamp - first_timestamp) / busy_seconds;
+}
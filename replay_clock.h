@@ -0,0 +1,56 @@
+#pragma once
+
+#include "idataset.h"
+#include <chrono>
+#include <cinttypes>
+#include <functional>
+
+namespace DynoGraph {
+
+// Releases batches at the times their edges arrived, according to their timestamps
+// Timestamps are scaled by the replay rate, so a batch is due (last timestamp - first timestamp) / rate
+// seconds after the replay starts. When the benchmark falls behind, the batches that came due in the
+// meantime are coalesced, so they can be inserted in a single update.
+class ReplayClock
+{
+public:
+    typedef std::chrono::steady_clock clock;
+    // Reads the current time
+    typedef std::function<clock::time_point()> now_function;
+    // Waits until the given time
+    typedef std::function<void(clock::time_point)> sleep_function;
+private:
+    now_function now;
+    sleep_function sleep_until;
+    // Timestamp units replayed per second
+    double rate;
+    // Timestamp that lines up with the start of the replay
+    int64_t first_timestamp;
+    // Latest timestamp released so far
+    int64_t last_timestamp;
+    clock::time_point start;
+    // Time spent waiting for batches to come due
+    clock::duration idle_time;
+    // How late the last batch was released, in milliseconds
+    double lag_ms;
+    double max_lag_ms;
+    int64_t num_missed_deadlines;
+public:
+    ReplayClock(double rate, int64_t first_timestamp);
+    // Uses the given functions in place of the steady clock, e.g. so tests can step through time
+    ReplayClock(double rate, int64_t first_timestamp, now_function now, sleep_function sleep_until);
+    // Waits for the batch to come due, and returns the last batch that should be inserted along with it
+    // If the batch is already late, the following batches up to last_batch_id that are also due get coalesced
+    // Coalescing stops at the first batch whose timestamp the dataset can't report without fetching it
+    int64_t wait_for_batch(IDataset &dataset, int64_t batch_id, int64_t last_batch_id);
+    // How late the last batch was released, in milliseconds
+    double get_lag_ms() const { return lag_ms; }
+    // Largest lag over all the batches
+    double get_max_lag_ms() const { return max_lag_ms; }
+    // Number of batches that were released late
+    int64_t get_num_missed_deadlines() const { return num_missed_deadlines; }
+    // Fastest replay rate the benchmark could have kept up with, based on how long it was busy
+    double get_sustainable_rate() const;
+};
+
+} // end namespace DynoGraph
@@ -0,0 +1,118 @@
+// Provides unit tests for the ReplayClock class
+
+#include "replay_clock.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+
+using namespace DynoGraph;
+
+namespace {
+
+// Batch i ends at timestamp 10 * (i + 1)
+// Only the first num_ready batches can report their timestamps without being fetched
+class FakeDataset : public IDataset
+{
+public:
+    int64_t num_ready;
+    FakeDataset() : num_ready(10) {}
+    int64_t getTimestampForWindow(int64_t batchId) const { return 0; }
+    std::shared_ptr<Batch> getBatch(int64_t batchId) { return std::make_shared<Batch>(); }
+    std::shared_ptr<Batch> getBatchesUpTo(int64_t batchId) { return std::make_shared<Batch>(); }
+    int64_t getLastTimestamp(int64_t batchId) { return 10 * (batchId + 1); }
+    bool hasLastTimestamp(int64_t batchId) const { return batchId < num_ready; }
+    int64_t getNumBatches() const { return 10; }
+    int64_t getNumEdges() const { return 0; }
+    bool isDirected() const { return true; }
+    int64_t getMaxVertexId() const { return 0; }
+    int64_t getMinTimestamp() const { return 0; }
+    int64_t getMaxTimestamp() const { return 100; }
+};
+
+// A clock that only moves when the test advances it, or when the replay sleeps
+class FakeClock
+{
+public:
+    typedef ReplayClock::clock clock;
+    clock::time_point time;
+    FakeClock() : time(clock::time_point() + std::chrono::hours(1)) {}
+    void advance_ms(int64_t ms) { time += std::chrono::milliseconds(ms); }
+    ReplayClock make_replay_clock(double rate)
+    {
+        return ReplayClock(rate, 0,
+            [this]() { return time; },
+            [this](clock::time_point until) { time = std::max(time, until); });
+    }
+    int64_t elapsed_ms(clock::time_point since) const
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time - since).count();
+    }
+};
+
+} // end anonymous namespace
+
+// Batches should not be released before their timestamps come due
+TEST(ReplayClockTest, WaitsForBatches)
+{
+    FakeDataset dataset;
+    FakeClock fake_clock;
+    // 100 timestamps per second, so each batch is due 100ms after the last one
+    ReplayClock replay_clock = fake_clock.make_replay_clock(100);
+    auto start = fake_clock.time;
+    EXPECT_EQ(replay_clock.wait_for_batch(dataset, 0, 9), 0);
+    EXPECT_EQ(fake_clock.elapsed_ms(start), 100);
+    EXPECT_EQ(replay_clock.wait_for_batch(dataset, 1, 9), 1);
+    EXPECT_EQ(fake_clock.elapsed_ms(start), 200);
+    EXPECT_EQ(replay_clock.get_num_missed_deadlines(), 0);
+    EXPECT_EQ(replay_clock.get_lag_ms(), 0);
+}
+
+// Batches that come due while the benchmark is busy should be coalesced, up to the limit
+TEST(ReplayClockTest, CoalescesLateBatches)
+{
+    FakeDataset dataset;
+    FakeClock fake_clock;
+    // 20 timestamps per second, so each batch is due 500ms after the last one
+    ReplayClock replay_clock = fake_clock.make_replay_clock(20);
+    fake_clock.advance_ms(1250);
+    // Batches 0 and 1 are due by now, and both missed their deadlines
+    EXPECT_EQ(replay_clock.wait_for_batch(dataset, 0, 9), 1);
+    EXPECT_EQ(replay_clock.get_num_missed_deadlines(), 2);
+    EXPECT_EQ(replay_clock.get_lag_ms(), 750);
+    // Coalescing stops at the end of the epoch, even though batch 4 is due too
+    fake_clock.advance_ms(1500);
+    EXPECT_EQ(replay_clock.wait_for_batch(dataset, 2, 3), 3);
+    EXPECT_EQ(replay_clock.get_num_missed_deadlines(), 4);
+    EXPECT_EQ(replay_clock.get_max_lag_ms(), 1250);
+    // Nothing was idle, so the rate it kept up with is the timestamps covered over the time taken
+    EXPECT_DOUBLE_EQ(replay_clock.get_sustainable_rate(), 40 / 2.75);
+}
+
+// Batches that come due at the moment they are released are on time
+TEST(ReplayClockTest, BatchesReleasedAtDeadlineAreOnTime)
+{
+    FakeDataset dataset;
+    FakeClock fake_clock;
+    ReplayClock replay_clock = fake_clock.make_replay_clock(20);
+    fake_clock.advance_ms(500);
+    EXPECT_EQ(replay_clock.wait_for_batch(dataset, 0, 9), 0);
+    EXPECT_EQ(replay_clock.get_num_missed_deadlines(), 0);
+    EXPECT_EQ(replay_clock.get_lag_ms(), 0);
+    // Batch 1 is late, and batch 2 is coalesced with it, but only batch 1 missed its deadline
+    fake_clock.advance_ms(1000);
+    EXPECT_EQ(replay_clock.wait_for_batch(dataset, 1, 9), 2);
+    EXPECT_EQ(replay_clock.get_num_missed_deadlines(), 1);
+    EXPECT_EQ(replay_clock.get_lag_ms(), 500);
+}
+
+// Batches that can't report their timestamps yet shouldn't be waited on just to see if they are due
+TEST(ReplayClockTest, DoesntCoalesceBatchesThatArentReady)
+{
+    FakeDataset dataset;
+    dataset.num_ready = 2;
+    FakeClock fake_clock;
+    ReplayClock replay_clock = fake_clock.make_replay_clock(20);
+    fake_clock.advance_ms(5000);
+    EXPECT_EQ(replay_clock.wait_for_batch(dataset, 0, 9), 1);
+    EXPECT_EQ(replay_clock.get_num_missed_deadlines(), 2);
+}
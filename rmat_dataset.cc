@@ -4,21 +4,6 @@
 
 using namespace DynoGraph;
 
-int64_t
-parse_int_with_suffix(std::string token)
-{
-    int64_t n = static_cast<int64_t>(std::stoll(token));
-    switch(token.back())
-    {
-        case 'K': n *= 1LL << 10; break;
-        case 'M': n *= 1LL << 20; break;
-        case 'G': n *= 1LL << 30; break;
-        case 'T': n *= 1LL << 40; break;
-        default: break;
-    }
-    return n;
-}
-
 RmatArgs
 RmatArgs::from_string(std::string str)
 {
@@ -58,12 +43,19 @@ RmatDataset::RmatDataset(Args args, RmatArgs rmat_args)
 , rmat_args(rmat_args)
 , current_batch(0)
 , num_edges(rmat_args.num_edges)
-, num_batches(num_edges / args.batch_size)
+, num_batches(0)
 , num_vertices(rmat_args.num_vertices)
 , next_timestamp(0)
 , generator(rmat_args.num_vertices, rmat_args.a, rmat_args.b, rmat_args.c, rmat_args.d)
+{
+    sliceBatches();
+}
+
+void
+RmatDataset::sliceBatches()
 {
     Logger &logger = Logger::get_instance();
+    num_batches = num_edges / args.batch_size;
 
     // Sanity check on arguments
     if (args.batch_size > num_edges)
@@ -101,10 +93,10 @@ std::shared_ptr<Batch>
 RmatDataset::getBatch(int64_t batchId)
 {
     // Since this is a graph generator, batches must be generated in order
-    if (current_batch != batchId) {
-        reset();
-        generator.discard(batchId * args.batch_size);
-    }
+    // Re-rolling self edges uses up a varying amount of the random stream, so the generator
+    // can't discard its way to a batch. Generate the batches in between instead.
+    if (current_batch > batchId) { reset(); }
+    while (current_batch < batchId) { getBatch(current_batch); }
     current_batch = batchId + 1;
 
     int64_t first_timestamp = next_timestamp;
@@ -116,18 +108,29 @@ std::shared_ptr<Batch>
 RmatDataset::getBatchesUpTo(int64_t batchId)
 {
     // Since this is a graph generator, batches must be generated in order
+    // Generate them one at a time, so the edges, timestamps and generator state afterwards
+    // all match what a sequence of calls to getBatch would produce
     reset();
-    current_batch = batchId + 1;
+    std::shared_ptr<ConcreteBatch> batches = std::make_shared<ConcreteBatch>((batchId + 1) * args.batch_size);
+    Edge* pos = batches->begin();
+    for (int64_t i = 0; i <= batchId; ++i) {
+        std::shared_ptr<Batch> batch = getBatch(i);
+        pos = std::copy(batch->begin(), batch->end(), pos);
+    }
+    return batches;
+}
 
-    int64_t first_timestamp = next_timestamp;
-    next_timestamp += args.batch_size;
-    return std::make_shared<RmatBatch>(generator, current_batch * args.batch_size, first_timestamp);
+int64_t
+RmatDataset::getLastTimestamp(int64_t batchId)
+{
+    // Each edge is timestamped with its position in the stream, so there's no need to generate the batch
+    return (batchId + 1) * args.batch_size - 1;
 }
 
 bool
 RmatDataset::isDirected() const
 {
-    return true;
+    return !args.undirected;
 }
 
 int64_t
@@ -163,6 +166,17 @@ RmatDataset::reset() {
     generator = rmat_edge_generator(rmat_args.num_vertices, rmat_args.a, rmat_args.b, rmat_args.c, rmat_args.d);
 }
 
+bool
+RmatDataset::reconfigure(const Args& new_args)
+{
+    // Generator parameters come from the input path
+    if (new_args.input_path != args.input_path) { return false; }
+    args = new_args;
+    sliceBatches();
+    reset();
+    return true;
+}
+
 // Implementation of RmatBatch
 RmatBatch::RmatBatch(rmat_edge_generator &generator, int64_t size, int64_t first_timestamp)
 : ConcreteBatch(size)
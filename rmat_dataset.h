@@ -32,12 +32,15 @@ private:
     int64_t num_vertices;
     int64_t next_timestamp;
     DynoGraph::rmat_edge_generator generator;
+    void sliceBatches();
 public:
     RmatDataset(Args args, RmatArgs rmat_args);
 
     int64_t getTimestampForWindow(int64_t batchId) const;
     std::shared_ptr<Batch> getBatch(int64_t batchId);
     std::shared_ptr<Batch> getBatchesUpTo(int64_t batchId);
+    int64_t getLastTimestamp(int64_t batchId);
+    bool hasLastTimestamp(int64_t batchId) const { return true; }
     int64_t getNumBatches() const;
     int64_t getNumEdges() const;
     int64_t getMinTimestamp() const;
@@ -47,6 +50,7 @@ public:
     int64_t getMaxVertexId() const;
 
     void reset();
+    bool reconfigure(const Args& args);
 };
 
 } // end namespace DynoGraph
@@ -160,4 +160,22 @@ TEST(RmatDatasetTest, NoSelfEdges)
             EXPECT_NE(e.src, e.dst);
         }
     }
-}
\ No newline at end of file
+}
+
+TEST(RmatDatasetTest, RandomAccessMatchesSequential)
+{
+    Args args = {1, "dummy", 1000, {}, DynoGraph::Args::SORT_MODE::SNAPSHOT, 1.0, 1, 1};
+    RmatArgs rmat_args = RmatArgs::from_string("0.55-0.20-0.10-0.15-10K-1K.rmat");
+    RmatDataset dataset(args, rmat_args);
+
+    std::vector<std::shared_ptr<Batch>> batches;
+    for (int64_t batch_id = 0; batch_id < dataset.getNumBatches(); ++batch_id) {
+        batches.push_back(dataset.getBatch(batch_id));
+    }
+    // Jump backwards and forwards, skipping batches that re-rolled self edges
+    for (int64_t batch_id : {7, 2, 9, 5}) {
+        std::shared_ptr<Batch> batch = dataset.getBatch(batch_id);
+        ASSERT_EQ(batch->size(), batches[batch_id]->size());
+        EXPECT_TRUE(std::equal(batch->begin(), batch->end(), batches[batch_id]->begin()));
+    }
+}
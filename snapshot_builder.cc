@@ -0,0 +1,117 @@
+#include "snapshot_builder.h"
+#include "edge_kernels.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace DynoGraph;
+using std::shared_ptr;
+using std::make_shared;
+
+SnapshotBuilder::SnapshotBuilder(const EdgeAggregation& aggregation, bool sort_by_degree)
+: num_batches(0), directed(true), aggregation(aggregation), sort_by_degree(sort_by_degree) {}
+
+shared_ptr<ConcreteBatch>
+SnapshotBuilder::get_new_edges(IDataset &dataset, int64_t batchId, int64_t threshold, int64_t growth)
+{
+    // Batches are sorted by timestamp, so filtering them before making a copy
+    // skips over the edges that are already outside the window without touching them
+    // Starting from scratch, the dataset can give us everything at once
+    if (num_batches == 0) {
+        shared_ptr<Batch> batches = dataset.getBatchesUpTo(batchId);
+        batches->filter(threshold);
+        return make_shared<ConcreteBatch>(*batches, batches->size() * growth);
+    }
+
+    // Otherwise, concatenate the batches that arrived since the last update
+    std::vector<shared_ptr<Batch>> batches;
+    size_t total_size = 0;
+    for (int64_t i = num_batches; i <= batchId; ++i) {
+        batches.push_back(dataset.getBatch(i));
+        batches.back()->filter(threshold);
+        total_size += batches.back()->size();
+    }
+    shared_ptr<ConcreteBatch> new_edges = make_shared<ConcreteBatch>(total_size, total_size * growth);
+    Edge* pos = new_edges->begin();
+    for (const shared_ptr<Batch>& batch : batches) {
+        pos = std::copy(batch->begin(), batch->end(), pos);
+    }
+    return new_edges;
+}
+
+void
+SnapshotBuilder::merge(Edge* new_begin, Edge* new_end, int64_t threshold)
+{
+    std::sort(new_begin, new_end, by_src_dst);
+
+    expire(threshold);
+
+    // Merge the new edges into the snapshot
+    pvector<Edge> merged;
+    BatchPool::get_instance().acquire(merged, edges.size() + (new_end - new_begin));
+    std::merge(edges.begin(), edges.end(), new_begin, new_end, merged.begin(), by_src_dst);
+    edges.swap(merged);
+    BatchPool::get_instance().release(merged);
+}
+
+void
+SnapshotBuilder::update(IDataset &dataset, int64_t batchId, int64_t threshold)
+{
+    // Batches have to be merged in order, so going backwards means starting over
+    if (batchId + 1 < num_batches) { reset(); }
+    if (batchId + 1 == num_batches) { return; }
+
+    // For undirected datasets, the new edges are symmetrized first, so the reverse edges get sorted along with them
+    directed = dataset.isDirected();
+    shared_ptr<ConcreteBatch> new_edges = get_new_edges(dataset, batchId, threshold, directed ? 1 : 2);
+    if (!directed) { new_edges->symmetrize(); }
+    merge(new_edges->begin(), new_edges->end(), threshold);
+    num_batches = batchId + 1;
+}
+
+void
+SnapshotBuilder::add_batch(const Batch& batch, int64_t threshold)
+{
+    directed = batch.is_directed();
+    // Preprocessed batches are no longer sorted by timestamp, so they can't be filtered by a search
+    ConcreteBatch new_edges(batch);
+    int64_t num_new_edges = compact_by_timestamp(new_edges.begin(), new_edges.size(), threshold);
+    merge(new_edges.begin(), new_edges.begin() + num_new_edges, threshold);
+    num_batches += 1;
+}
+
+void
+SnapshotBuilder::expire(int64_t threshold)
+{
+    // Drop the edges that fell out of the window, like the deletions in the dynamic graph
+    // The snapshot is sorted by src and dst rather than by time, so this is a compaction pass
+    edges.resize(compact_by_timestamp(edges.begin(), edges.size(), threshold));
+}
+
+shared_ptr<Batch>
+SnapshotBuilder::get_snapshot(IDataset &dataset, int64_t batchId, int64_t threshold)
+{
+    update(dataset, batchId, threshold);
+    // Hand out a copy with the duplicates combined, so the caller can't disturb the order of the snapshot
+    shared_ptr<GroupedBatch> snapshot = make_shared<GroupedBatch>(get_edges());
+    snapshot->combine_sorted_duplicates(std::numeric_limits<int64_t>::min(), aggregation);
+    if (sort_by_degree) { snapshot->sort_by_out_degree(); }
+    snapshot->index_sources();
+    return snapshot;
+}
+
+Batch
+SnapshotBuilder::get_edges() const
+{
+    Batch window(edges);
+    window.set_directed(directed);
+    return window;
+}
+
+void
+SnapshotBuilder::reset()
+{
+    // Hand the storage back, so the next trial can reuse it
+    BatchPool::get_instance().release(edges);
+    num_batches = 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "batch.h"
+#include "idataset.h"
+#include "pvector.h"
+#include <memory>
+
+namespace DynoGraph {
+
+// Maintains a sorted snapshot of the edges in the window between epochs
+// Each call only sorts the batches that arrived since the last call, then merges them into the snapshot
+//
+// Duplicates are kept apart in the window and only combined in the copy that get_snapshot hands out,
+// so when some copies of an edge expire, their weight leaves with them, just as if the snapshot had
+// been rebuilt from scratch. The copy is made and combined in linear passes over the window.
+// Ordering it by degree sorts the sources, and each source's own edges, but never the whole window.
+class SnapshotBuilder
+{
+private:
+    // Edges in the current window, sorted by src and dst. Duplicates are not combined.
+    pvector<Edge> edges;
+    // Number of batches from the dataset that have been merged into the snapshot
+    int64_t num_batches;
+    // False if the snapshot holds both directions of every edge
+    bool directed;
+    // How duplicate edges are combined
+    EdgeAggregation aggregation;
+    // If false, snapshots are left sorted by src and dst
+    bool sort_by_degree;
+    // Returns the edges in batches [num_batches, batchId] as a single batch, with room to grow by a factor of growth
+    // Edges older than threshold are left out
+    std::shared_ptr<ConcreteBatch> get_new_edges(IDataset &dataset, int64_t batchId, int64_t threshold, int64_t growth);
+    // Drops the edges older than threshold, then sorts the new edges and merges them in
+    void merge(Edge* new_begin, Edge* new_end, int64_t threshold);
+public:
+    explicit SnapshotBuilder(const EdgeAggregation& aggregation = EdgeAggregation(), bool sort_by_degree = true);
+    // Returns a snapshot of all edges up to and including batchId, sorted by out degree (or by src and dst,
+    // if sort_by_degree is false) and grouped by source.
+    // Edges with a timestamp older than threshold are removed.
+    std::shared_ptr<Batch> get_snapshot(IDataset &dataset, int64_t batchId, int64_t threshold);
+    // Bring the snapshot up to date without making a copy of it
+    void update(IDataset &dataset, int64_t batchId, int64_t threshold);
+    // Merges in a batch that was already fetched from the dataset, as the next batch, dropping edges older than threshold
+    void add_batch(const Batch& batch, int64_t threshold);
+    // Drops the edges older than threshold from the window
+    void expire(int64_t threshold);
+    // Returns the edges in the window, sorted by src and dst. Duplicate edges are not combined.
+    Batch get_edges() const;
+    // Discard the snapshot and start over from the first batch
+    void reset();
+};
+
+} // end namespace DynoGraph
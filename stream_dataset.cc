@@ -0,0 +1,303 @@
+#include "stream_dataset.h"
+#include "helpers.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace DynoGraph;
+using std::shared_ptr;
+using std::make_shared;
+using std::string;
+
+StreamArgs
+StreamArgs::from_string(string str)
+{
+    StreamArgs args;
+    // Format is ne-nv-timeout_ms@source.stream
+    // Example: 500M-1M-100@unix:/tmp/edges.sock.stream
+    size_t at = str.find('@');
+    std::istringstream ss(str.substr(0, at));
+    string token;
+    std::getline(ss, token, '-'); args.num_edges = parse_int_with_suffix(token);
+    std::getline(ss, token, '-'); args.num_vertices = parse_int_with_suffix(token);
+    std::getline(ss, token, '-'); args.timeout_ms = parse_int_with_suffix(token);
+    if (at != string::npos) {
+        args.source = str.substr(at + 1, str.size() - at - 1 - string(".stream").size());
+    }
+    return args;
+}
+
+string
+StreamArgs::validate() const
+{
+    std::ostringstream oss;
+    if (num_edges <= 0 || num_vertices <= 0) {
+        oss << "Invalid arguments: stream must have a positive number of edges and vertices\n";
+    } else if (timeout_ms < 0) {
+        oss << "Invalid arguments: stream timeout cannot be negative\n";
+    } else if (source.empty()) {
+        oss << "Invalid arguments: stream source cannot be empty\n";
+    }
+    return oss.str();
+}
+
+namespace {
+
+// Returns a file descriptor for reading from the source
+int
+open_source(const string& source)
+{
+    Logger &logger = Logger::get_instance();
+    if (source == "-") { return STDIN_FILENO; }
+
+    const string unix_prefix = "unix:";
+    if (source.compare(0, unix_prefix.size(), unix_prefix) != 0) {
+        logger << "Opening " << source << " for streaming\n";
+        int fd = open(source.c_str(), O_RDONLY);
+        if (fd < 0) {
+            logger << "Failed to open " << source << ": " << strerror(errno) << "\n";
+            die();
+        }
+        return fd;
+    }
+
+    // Listen on the socket, and read from the first writer that connects
+    string path = source.substr(unix_prefix.size());
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        logger << "Socket path is too long: " << path << "\n";
+        die();
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str());
+    if (listener < 0
+    ||  bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+    ||  listen(listener, 1) < 0) {
+        logger << "Failed to listen on " << path << ": " << strerror(errno) << "\n";
+        die();
+    }
+    logger << "Waiting for a connection on " << path << "\n";
+    int fd = accept(listener, nullptr, nullptr);
+    if (fd < 0) {
+        logger << "Failed to accept a connection on " << path << ": " << strerror(errno) << "\n";
+        die();
+    }
+    close(listener);
+    unlink(path.c_str());
+    return fd;
+}
+
+} // end anonymous namespace
+
+StreamDataset::StreamDataset(Args args, StreamArgs stream_args)
+: args(args)
+, stream_args(stream_args)
+, num_batches(stream_args.num_edges / args.batch_size)
+, fd(-1)
+, edges(stream_args.num_edges)
+, num_bytes(0)
+, offsets(num_batches + 1, 0)
+, arrival_times(num_batches)
+, num_ready(0)
+, end_of_stream(false)
+, num_replayed(0)
+{
+    Logger &logger = Logger::get_instance();
+
+    // Sanity check on arguments
+    if (args.batch_size > stream_args.num_edges)
+    {
+        logger << "Invalid arguments: batch size (" << args.batch_size << ") "
+               << "cannot be larger than the total number of edges in the stream "
+               << " (" << stream_args.num_edges << ")\n";
+        die();
+    }
+
+    if (args.num_epochs > num_batches)
+    {
+        logger << "Invalid arguments: number of epochs (" << args.num_epochs << ") "
+               << "cannot be greater than the number of batches in the stream "
+               << "(" << num_batches << ")\n";
+        die();
+    }
+
+    fd = open_source(stream_args.source);
+}
+
+StreamDataset::~StreamDataset()
+{
+    if (fd > STDIN_FILENO) { close(fd); }
+}
+
+void
+StreamDataset::receive_batch() const
+{
+    Logger &logger = Logger::get_instance();
+    using clock = std::chrono::steady_clock;
+
+    int64_t batch_id = num_ready.load();
+    int64_t begin = offsets[batch_id];
+    int64_t end = std::min(begin + args.batch_size, stream_args.num_edges);
+    char* buffer = reinterpret_cast<char*>(edges.begin());
+    size_t end_bytes = end * sizeof(Edge);
+    // Once the first edge arrives, the batch is cut off at the deadline
+    bool arrived = false;
+    clock::time_point deadline;
+
+    // Reads block, so a writer that gets ahead of the benchmark is held back by the pipe
+    while (!end_of_stream && num_bytes < end_bytes)
+    {
+        if (arrived && stream_args.timeout_ms > 0) {
+            int64_t remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - clock::now()).count();
+            if (remaining_ms <= 0) { break; }
+            pollfd p = {fd, POLLIN, 0};
+            int rc = poll(&p, 1, static_cast<int>(remaining_ms));
+            if (rc == 0) { break; }
+            if (rc < 0 && errno == EINTR) { continue; }
+        }
+        ssize_t n = read(fd, buffer + num_bytes, end_bytes - num_bytes);
+        if (n < 0) {
+            if (errno == EINTR) { continue; }
+            logger << "Failed to read from " << stream_args.source << ": " << strerror(errno) << "\n";
+            die();
+        } else if (n == 0) {
+            logger << "Stream ended after " << num_bytes / sizeof(Edge) << " edges\n";
+            end_of_stream = true;
+        }
+        num_bytes += n;
+        if (!arrived && num_bytes >= (begin + 1) * sizeof(Edge)) {
+            arrived = true;
+            arrival_times[batch_id] = clock::now();
+            deadline = arrival_times[batch_id] + std::chrono::milliseconds(stream_args.timeout_ms);
+        }
+    }
+    // Edges that are still partway through arriving go to the next batch
+    end = num_bytes / sizeof(Edge);
+
+    // Check the new edges, and keep timestamps in order so batches can be filtered by the window
+    for (int64_t i = begin; i < end; ++i) {
+        Edge& e = edges[i];
+        if (e.src < 0 || e.dst < 0 || e.src >= stream_args.num_vertices || e.dst >= stream_args.num_vertices) {
+            logger << "Invalid stream: vertex ID out of range in edge " << i << "\n";
+            die();
+        }
+        if (e.src == e.dst) {
+            logger << "Invalid stream: no self-edges allowed\n";
+            die();
+        }
+        if (i > 0) { e.timestamp = std::max(e.timestamp, edges[i-1].timestamp); }
+    }
+
+    offsets[batch_id + 1] = end;
+    if (!arrived) { arrival_times[batch_id] = clock::time_point::min(); }
+    num_ready.store(batch_id + 1);
+}
+
+void
+StreamDataset::wait_for_batch(int64_t batchId) const
+{
+    if (batchId < num_ready.load()) { return; }
+    std::lock_guard<std::mutex> lock(receive_mutex);
+    while (batchId >= num_ready.load()) { receive_batch(); }
+}
+
+int64_t
+StreamDataset::getTimestampForWindow(int64_t batchId) const
+{
+    wait_for_batch(batchId);
+    // The window holds the most recent window_size fraction of the stream's edges
+    int64_t window_edges = round_down(args.window_size * stream_args.num_edges);
+    int64_t end = offsets[batchId + 1];
+    if (end == 0) { return 0; }
+    return edges[std::max(end - window_edges, static_cast<int64_t>(0))].timestamp;
+}
+
+shared_ptr<Batch>
+StreamDataset::getBatch(int64_t batchId)
+{
+    wait_for_batch(batchId);
+    return make_shared<Batch>(edges.begin() + offsets[batchId], edges.begin() + offsets[batchId + 1]);
+}
+
+shared_ptr<Batch>
+StreamDataset::getBatchesUpTo(int64_t batchId)
+{
+    wait_for_batch(batchId);
+    return make_shared<Batch>(edges.begin(), edges.begin() + offsets[batchId + 1]);
+}
+
+shared_ptr<Batch>
+StreamDataset::getExpiredEdges(int64_t batchId)
+{
+    // Edges between the window threshold of the previous batch and this one have expired
+    int64_t begin_time = batchId == 0 ? getMinTimestamp() : getTimestampForWindow(batchId - 1);
+    int64_t end_time = getTimestampForWindow(batchId);
+    auto by_timestamp = [](const Edge& a, const Edge& b) { return a.timestamp < b.timestamp; };
+    Edge* first = edges.begin();
+    Edge* last = edges.begin() + offsets[batchId + 1];
+    Edge* expired_begin = std::lower_bound(first, last, Edge{0, 0, 0, begin_time}, by_timestamp);
+    Edge* expired_end = std::lower_bound(expired_begin, last, Edge{0, 0, 0, end_time}, by_timestamp);
+    return make_shared<Batch>(expired_begin, expired_end);
+}
+
+double
+StreamDataset::getArrivalTime(int64_t batchId) const
+{
+    wait_for_batch(batchId);
+    if (batchId < num_replayed || arrival_times[batchId] == std::chrono::steady_clock::time_point::min()) { return -1; }
+    return std::chrono::duration<double>(arrival_times[batchId].time_since_epoch()).count();
+}
+
+bool
+StreamDataset::isDirected() const
+{
+    return !args.undirected;
+}
+
+int64_t
+StreamDataset::getMaxVertexId() const
+{
+    return stream_args.num_vertices - 1;
+}
+
+int64_t
+StreamDataset::getNumBatches() const
+{
+    return num_batches;
+}
+
+int64_t
+StreamDataset::getNumEdges() const
+{
+    return stream_args.num_edges;
+}
+
+int64_t
+StreamDataset::getMinTimestamp() const
+{
+    return num_ready.load() > 0 && offsets[num_ready.load()] > 0 ? edges[0].timestamp : 0;
+}
+
+int64_t
+StreamDataset::getMaxTimestamp() const
+{
+    int64_t end = offsets[num_ready.load()];
+    return end > 0 ? edges[end - 1].timestamp : 0;
+}
+
+void
+StreamDataset::reset()
+{
+    // Batches that were already received are replayed from memory, later ones still arrive live
+    num_replayed = num_ready.load();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "args.h"
+#include "batch.h"
+#include "idataset.h"
+#include "pvector.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace DynoGraph {
+
+struct StreamArgs
+{
+    // Most edges that will be read from the stream
+    int64_t num_edges;
+    // Vertex ID's in the stream must be less than this
+    int64_t num_vertices;
+    // A batch is cut short this many milliseconds after its first edge arrives (0 waits for a full batch)
+    int64_t timeout_ms;
+    // Where to read edges from: "-" for stdin, "unix:<path>" to listen on a Unix socket, or the path to a FIFO
+    std::string source;
+
+    static StreamArgs from_string(std::string str);
+    std::string validate() const;
+};
+
+// Reads binary Edge records from a pipe or socket as the benchmark asks for each batch
+// Edges are kept after they are read, so later trials replay the same batches
+class StreamDataset : public IDataset
+{
+private:
+    Args args;
+    StreamArgs stream_args;
+    int64_t num_batches;
+    int fd;
+
+    // Everything below is filled in as batches are received, which can happen in a const getter
+    // Storage for every edge that can be received, so batches never move
+    mutable pvector<Edge> edges;
+    // Number of bytes received, which can end partway through an edge
+    mutable size_t num_bytes;
+    // Batch i holds edges [offsets[i], offsets[i+1])
+    mutable std::vector<int64_t> offsets;
+    // When the first edge of each batch was received
+    mutable std::vector<std::chrono::steady_clock::time_point> arrival_times;
+    // Number of batches that have been received
+    mutable std::atomic<int64_t> num_ready;
+    // Set when the writer closes the stream
+    mutable bool end_of_stream;
+    // Batches before this one were received before the last reset, so their arrival times aren't meaningful
+    int64_t num_replayed;
+    // Only one thread reads from the stream at a time
+    mutable std::mutex receive_mutex;
+
+    void receive_batch() const;
+    void wait_for_batch(int64_t batchId) const;
+public:
+    StreamDataset(Args args, StreamArgs stream_args);
+    ~StreamDataset();
+
+    int64_t getTimestampForWindow(int64_t batchId) const;
+    std::shared_ptr<Batch> getBatch(int64_t batchId);
+    std::shared_ptr<Batch> getBatchesUpTo(int64_t batchId);
+    std::shared_ptr<Batch> getExpiredEdges(int64_t batchId);
+    double getArrivalTime(int64_t batchId) const;
+    // Only batches that have already been received can be looked at without waiting
+    bool hasLastTimestamp(int64_t batchId) const { return batchId < num_ready.load(); }
+    int64_t getNumBatches() const;
+    int64_t getNumEdges() const;
+    int64_t getMinTimestamp() const;
+    int64_t getMaxTimestamp() const;
+
+    bool isDirected() const;
+    int64_t getMaxVertexId() const;
+
+    void reset();
+};
+
+} // end namespace DynoGraph
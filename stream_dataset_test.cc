@@ -0,0 +1,136 @@
+// Provides unit tests for the StreamDataset class
+
+#include "stream_dataset.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace DynoGraph;
+
+namespace {
+
+Args
+stream_test_args(int64_t batch_size)
+{
+    Args args = Args();
+    args.num_epochs = 1;
+    args.batch_size = batch_size;
+    args.sort_mode = Args::SORT_MODE::UNSORTED;
+    args.window_size = 1.0;
+    args.num_trials = 1;
+    return args;
+}
+
+std::vector<Edge>
+make_edges(int64_t n)
+{
+    std::vector<Edge> edges(n);
+    for (int64_t i = 0; i < n; ++i) {
+        edges[i] = {i % 10, (i + 1) % 10, 1, 100 + i};
+    }
+    return edges;
+}
+
+} // end anonymous namespace
+
+TEST(StreamArgsTest, ParseFromString)
+{
+    StreamArgs stream_args = StreamArgs::from_string("12M-8K-50@unix:/tmp/edges.sock.stream");
+    EXPECT_EQ(stream_args.num_edges, 12LL * 1024 * 1024);
+    EXPECT_EQ(stream_args.num_vertices, 8LL * 1024);
+    EXPECT_EQ(stream_args.timeout_ms, 50);
+    EXPECT_EQ(stream_args.source, "unix:/tmp/edges.sock");
+    EXPECT_TRUE(stream_args.validate().empty());
+
+    stream_args = StreamArgs::from_string("100-10-0@-.stream");
+    EXPECT_EQ(stream_args.source, "-");
+    EXPECT_TRUE(stream_args.validate().empty());
+
+    // Missing source
+    stream_args = StreamArgs::from_string("100-10-0.stream");
+    EXPECT_FALSE(stream_args.validate().empty());
+}
+
+// Batches read from a file should match the edges written to it, in order
+TEST(StreamDatasetTest, ReadsFullBatches)
+{
+    std::vector<Edge> edges = make_edges(100);
+    char path[] = "/tmp/stream_dataset_test_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, edges.data(), edges.size() * sizeof(Edge)), static_cast<ssize_t>(edges.size() * sizeof(Edge)));
+    close(fd);
+
+    StreamArgs stream_args = StreamArgs::from_string("100-10-0@" + std::string(path) + ".stream");
+    StreamDataset dataset(stream_test_args(25), stream_args);
+    ASSERT_EQ(dataset.getNumBatches(), 4);
+    for (int64_t batch_id = 0; batch_id < 4; ++batch_id) {
+        auto batch = dataset.getBatch(batch_id);
+        ASSERT_EQ(batch->size(), 25);
+        for (size_t i = 0; i < batch->size(); ++i) {
+            EXPECT_EQ((*batch)[i].timestamp, edges[batch_id * 25 + i].timestamp);
+        }
+        EXPECT_GE(dataset.getArrivalTime(batch_id), 0);
+    }
+    EXPECT_EQ(dataset.getBatchesUpTo(3)->size(), 100);
+
+    // Replayed batches don't report an arrival time
+    dataset.reset();
+    EXPECT_EQ(dataset.getBatch(0)->size(), 25);
+    EXPECT_LT(dataset.getArrivalTime(0), 0);
+    unlink(path);
+}
+
+// A writer that stalls partway through a batch should get a short batch after the timeout
+TEST(StreamDatasetTest, CutsBatchesOnTimeout)
+{
+    std::vector<Edge> edges = make_edges(40);
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    // The writer holds back the rest of the edges until the short batch has been cut, however slow the reader is
+    std::promise<void> first_batch_read;
+    std::thread writer([&]() {
+        ASSERT_EQ(write(fds[1], edges.data(), 15 * sizeof(Edge)), static_cast<ssize_t>(15 * sizeof(Edge)));
+        first_batch_read.get_future().wait();
+        ASSERT_EQ(write(fds[1], edges.data() + 15, 25 * sizeof(Edge)), static_cast<ssize_t>(25 * sizeof(Edge)));
+        close(fds[1]);
+    });
+
+    // Read from the pipe through its /proc entry, the same way a FIFO would be opened
+    std::string source = "/proc/self/fd/" + std::to_string(fds[0]);
+    StreamDataset dataset(stream_test_args(20), StreamArgs::from_string("40-10-50@" + source + ".stream"));
+    EXPECT_EQ(dataset.getBatch(0)->size(), 15);
+    first_batch_read.set_value();
+    EXPECT_EQ(dataset.getBatch(1)->size(), 20);
+    writer.join();
+    close(fds[0]);
+}
+
+// Batches received after a reset arrive live, so only the ones received before it lose their arrival times
+TEST(StreamDatasetTest, ReplaysOnlyReceivedBatches)
+{
+    std::vector<Edge> edges = make_edges(100);
+    char path[] = "/tmp/stream_dataset_test_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, edges.data(), edges.size() * sizeof(Edge)), static_cast<ssize_t>(edges.size() * sizeof(Edge)));
+    close(fd);
+
+    StreamArgs stream_args = StreamArgs::from_string("100-10-0@" + std::string(path) + ".stream");
+    StreamDataset dataset(stream_test_args(25), stream_args);
+    EXPECT_GE(dataset.getArrivalTime(1), 0);
+
+    dataset.reset();
+    EXPECT_LT(dataset.getArrivalTime(0), 0);
+    EXPECT_LT(dataset.getArrivalTime(1), 0);
+    EXPECT_GE(dataset.getArrivalTime(2), 0);
+
+    dataset.reset();
+    EXPECT_LT(dataset.getArrivalTime(2), 0);
+    EXPECT_GE(dataset.getArrivalTime(3), 0);
+    unlink(path);
+}